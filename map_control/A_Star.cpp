@@ -1,99 +1,290 @@
 #include "A_Star.h"
+#include "Prepared_Roadmap.h"
+#include "Path_Cache.h"
+#include "Roadmap_Snap_Field.h"
+#include "Landmark_Table.h"
+#include "Roadmap_Graph.h"
+#include "Roadmap_Distance_Table.h"
+#include "Contraction_Hierarchy.h"
+#include "Navigation_Field.h"
+#include "Thread_Pool.h"
 
 // -----------------------------------------------------------------------
 
-A_Star::A_Star() {}
+A_Star::A_Star() : open_list( make_open_list( OPEN_LIST_BINARY_HEAP ) ) {}
 
 // -----------------------------------------------------------------------
 
 A_Star::~A_Star() {}
 
-A_Star::A_Star(const cv::Mat &draw)
+A_Star::A_Star(const cv::Mat &draw) : open_list( make_open_list( OPEN_LIST_BINARY_HEAP ) )
 {
     map_a_star = draw.clone();
 }
 
 // -----------------------------------------------------------------------
 
+void A_Star::set_open_list_policy( const int policy )
+{
+    open_list_policy = policy;
+    open_list.reset( make_open_list( policy ) );
+    open_list->reserve( g.size() ); // Cells of the loaded map, if any
+}
+
+// -----------------------------------------------------------------------
+
+int A_Star::get_open_list_policy() { return open_list_policy; }
+
+// -----------------------------------------------------------------------
+
+void A_Star::set_expansion_mode( const int mode ) { expansion_mode = mode; }
+
+// -----------------------------------------------------------------------
+
+int A_Star::get_expansion_mode() { return expansion_mode; }
+
+// -----------------------------------------------------------------------
+
+void A_Star::set_landmarks( const Landmark_Table *landmarks ) { this->landmarks = landmarks; }
+
+// -----------------------------------------------------------------------
+
+const Landmark_Table *A_Star::get_landmarks() { return landmarks; }
+
+// -----------------------------------------------------------------------
+
+void A_Star::load_map(const cv::Mat &img,
+                      const cv::Point &start,
+                      const cv::Point &goal,
+                      const bool floor_plan)
+{
+    map_size = Map_Size( img.cols, img.rows );
+    stride = (int)map_size.width + 2;
+    size_t cells = (size_t)stride * ( map_size.height + 2 );
+    open_list->reserve( cells );
+
+    // Every cell starts blocked, the free pixels are cleared below, the border ring stays blocked
+    blocked.assign( cells, true );
+    closed.assign( cells, false );
+    g.assign( cells, G_UNSEEN );
+    parent.resize( cells );
+
+    for (int y = 0; y < img.rows; y++)
+    {
+        const Vec3b *row = img.ptr<Vec3b>( y );
+        for (int x = 0; x < img.cols; x++)
+            if ( floor_plan ? ( row[x] != Vec3b(0,0,0) )     // If pixel not black => free
+                            : ( row[x] == Vec3b(0,0,255) ) )  // If pixel red => roadmap
+                blocked.reset( index_of( x, y ) );
+    }
+
+    start_index = index_of( start.x, start.y );
+    goal_index = index_of( goal.x, goal.y );
+    blocked.reset( start_index ); // Start and goal are free even if they are not on the roadmap
+    blocked.reset( goal_index );
+
+    // The table only holds distances in its own grid, another map of the same size or a start or goal
+    // off the roadmap could make the heuristic overestimate
+    use_landmarks = landmarks && landmarks->matches( img, floor_plan ) &&
+                    landmarks->is_free( start ) && landmarks->is_free( goal );
+
+    // L, T, R, B, LT, RT, RB, LB
+    const int o[8] = { -1, -stride, 1, stride, -stride - 1, -stride + 1, stride + 1, stride - 1 };
+    std::copy( o, o + 8, offsets );
+}
+
+// -----------------------------------------------------------------------
+
+template<class Observer>
+std::vector<cv::Point> A_Star::search(const cv::Mat &img,
+                                      const cv::Point &start,
+                                      const cv::Point &goal,
+                                      const bool floor_plan,
+                                      Observer &observer)
+{
+    load_map( img, start, goal, floor_plan );
+
+    std::vector<cv::Point> result = find( observer );
+
+    if ( !result.empty() )
+        observer.on_path( result );
+
+    return result;
+}
+
+// -----------------------------------------------------------------------
+
 std::vector<cv::Point> A_Star::get_path(const cv::Mat &road_map,
                                         const cv::Point &start,
                                         const cv::Point &goal)
 {
-    open_list.clear();
-    map = road_map.clone();
-    map.at<Vec3b>( start ) = Vec3b( 255, 0, 0 );    // Start point = blue
-    map.at<Vec3b>( goal ) = Vec3b( 0, 255, 0 );     // End point  = green
+    if ( map_a_star.empty() )
+    {
+        Null_Search_Observer observer;
+        return search( road_map, start, goal, false, observer );
+    }
 
-    map_size = Map_Size( map.cols, map.rows );
-    map_data = vector<Map_Node>( map_size.size );
-    // Initilize map_data, Matrix form to vector form (y * map_size.width + x) (maybe linked-list)
-    for (int y = 0; y < map.rows; y++)
-        for (int x = 0; x < map.cols; x++)
-        {
-            if ( map.at<Vec3b>(y,x) == Vec3b(0,0,255) ) // If pixel red => roadmap
-            {
-                map_data[ y * map_size.width + x ] = Map_Node( x, y, NODE_TYPE_ZERO );
-            }
-            else if ( map.at<Vec3b>(y,x) == Vec3b(255,0,0) )    // If pixel blue => start point
-            {
-                Map_Node n( x, y, NODE_TYPE_START );
-                map_data[ y * map_size.width + x ] = n;
-                start_node = &map_data[ y * map_size.width + x ];
-            }
-            else if ( map.at<Vec3b>(y,x) == Vec3b(0,255,0) )    // If pixel green => end point
-            {
-                Map_Node n( x, y, NODE_TYPE_END );
-                map_data[ y * map_size.width + x ] = n;
-                goal_node = &map_data[ y * map_size.width + x ];
-            }
-            else    // If not red, green or blue then obstacle
-            {
-                map_data[ y * map_size.width + x ] = Map_Node( x, y, NODE_TYPE_OBSTACLE);
-            }
-        }
+    Draw_Search_Observer observer( map_a_star, start, goal, DRAW_OPEN_LIST );
+    return search( road_map, start, goal, false, observer );
+}
 
-    open_list.push_back( start_node );
-    vector<Map_Node *> path = find();
+// -----------------------------------------------------------------------
 
-    draw_path( path );
+template<class Observer>
+std::vector<cv::Point> A_Star::get_path(const cv::Mat &road_map,
+                                        const cv::Point &start,
+                                        const cv::Point &goal,
+                                        Observer &observer)
+{
+    return search( road_map, start, goal, false, observer );
+}
 
+// -----------------------------------------------------------------------
+
+std::vector<cv::Point> A_Star::get_floor_plan_path(const cv::Mat &floor_plan,
+                                                   const cv::Point &start,
+                                                   const cv::Point &goal)
+{
+    if ( map_a_star.empty() )
+    {
+        Null_Search_Observer observer;
+        return search( floor_plan, start, goal, true, observer );
+    }
+
+    Draw_Search_Observer observer( map_a_star, start, goal, DRAW_OPEN_LIST );
+    return search( floor_plan, start, goal, true, observer );
+}
+
+// -----------------------------------------------------------------------
+
+template<class Observer>
+std::vector<cv::Point> A_Star::get_floor_plan_path(const cv::Mat &floor_plan,
+                                                   const cv::Point &start,
+                                                   const cv::Point &goal,
+                                                   Observer &observer)
+{
+    return search( floor_plan, start, goal, true, observer );
+}
+
+// -----------------------------------------------------------------------
+
+std::vector<cv::Point> A_Star::get_path(Roadmap_Graph &graph,
+                                        const cv::Point &start,
+                                        const cv::Point &goal)
+{
     std::vector<cv::Point> result;
-    for ( auto& p : path )
-        result.push_back( Point( p->x, p->y ) );
+    graph.find_path( start, goal, result );
+
+    draw_path( result );
 
     return result;
 }
 
 // -----------------------------------------------------------------------
 
-int A_Star::manhatten_dist(const Map_Node *node1, const Map_Node *node2)
+std::vector<cv::Point> A_Star::get_path(Contraction_Hierarchy &hierarchy,
+                                        const cv::Point &start,
+                                        const cv::Point &goal)
 {
-    return abs( node2->x - node1->x ) + abs( node2->y - node1->y );
+    std::vector<cv::Point> result;
+    hierarchy.find_path( start, goal, result );
+
+    draw_path( result );
+
+    return result;
 }
 
 // -----------------------------------------------------------------------
 
-int A_Star::diagonal_dist(const Map_Node *node1, const Map_Node *node2) // Optimize with double and euclidean distances
+std::vector<cv::Point> A_Star::get_path(const Navigation_Field &field,
+                                        const cv::Point &start)
 {
-    return max( abs( node2->x - node1->x ), abs( node2->y - node1->y ) );
+    std::vector<cv::Point> result;
+    field.find_path( start, result );
+
+    draw_path( result );
+
+    return result;
 }
 
 // -----------------------------------------------------------------------
 
-int A_Star::compute_h(const Map_Node *node1, const Map_Node *node2)
+std::vector<cv::Point> A_Star::get_bidirectional_path(Prepared_Roadmap &road_map,
+                                                      const cv::Point &start,
+                                                      const cv::Point &goal)
 {
-    if ( ALLOW_VERTEX_PASSTHROUGH )
-        return diagonal_dist( node1, node2 ) * G_SKEW;
+    std::vector<cv::Point> result;
+    road_map.find_path_bidirectional( start, goal, result );
+
+    draw_path( result );
+
+    return result;
+}
+
+// -----------------------------------------------------------------------
+
+std::vector<cv::Point> A_Star::get_cached_path(const Prepared_Roadmap &road_map,
+                                               Path_Cache &cache,
+                                               const cv::Point &entry,
+                                               const cv::Point &exit)
+{
+    std::vector<cv::Point> result;
+    cache.find_path( road_map, entry, exit, result );
+
+    draw_path( result );
+
+    return result;
+}
+
+// -----------------------------------------------------------------------
+
+vector<vector<Point>> A_Star::get_paths(const Roadmap_Graph &graph,
+                                        const vector<pair<Point, Point>> &queries,
+                                        Thread_Pool &pool) const
+{
+    vector<vector<Point>> result;
+    graph.find_paths( queries, result, pool );
+    return result;
+}
+
+// -----------------------------------------------------------------------
+
+int A_Star::manhatten_dist(const int id1, const int id2)
+{
+    return abs( id2 % stride - id1 % stride ) + abs( id2 / stride - id1 / stride );
+}
+
+// -----------------------------------------------------------------------
+
+int A_Star::diagonal_dist(const int id1, const int id2) // Optimize with double and euclidean distances
+{
+    return max( abs( id2 % stride - id1 % stride ), abs( id2 / stride - id1 / stride ) );
+}
+
+// -----------------------------------------------------------------------
+
+int A_Star::compute_h(const int id1, const int id2)
+{
+    if ( use_landmarks ) // Consistent, at least as tight as the octile distance
+    {
+        int p1 = ( id1 / stride - 1 ) * (int)map_size.width + id1 % stride - 1;
+        int p2 = ( id2 / stride - 1 ) * (int)map_size.width + id2 % stride - 1;
+        return max( compute_g( id1, id2 ), landmarks->lower_bound( p1, p2 ) );
+    }
+    else if ( expansion_mode == EXPANSION_JUMP_POINTS ) // Must not overestimate, else the pruning loses optimality
+        return compute_g( id1, id2 );
+    else if ( ALLOW_VERTEX_PASSTHROUGH )
+        return diagonal_dist( id1, id2 ) * G_SKEW;
     else
-        return manhatten_dist( node1, node2 ) * G_DIRECT;
+        return manhatten_dist( id1, id2 ) * G_DIRECT;
 }
 
 // -----------------------------------------------------------------------
 
-int A_Star::compute_g(const Map_Node *node1, const Map_Node *node2) // Good as long only adjencet pixels
+int A_Star::compute_g(const int id1, const int id2) // Good as long only adjencet pixels
 {
-    int dx = abs( node1->x - node2->x );
-    int dy = abs( node1->y - node2->y );
+    int dx = abs( id1 % stride - id2 % stride );
+    int dy = abs( id1 / stride - id2 / stride );
   
     if ( dx > dy )
         return G_SKEW * dy + G_DIRECT * ( dx - dy ); // Distance between adjecent pixels
@@ -103,150 +294,470 @@ int A_Star::compute_g(const Map_Node *node1, const Map_Node *node2) // Good as l
 
 // -----------------------------------------------------------------------
 
-Map_Node *A_Star::map_at(const int x, const int y)
+int A_Star::neighbors(const int id, int *out)
 {
-    if ( x < 0 || y < 0 ||
-         x >= (int)map_size.width ||
-         y >= (int)map_size.height )
+    int amount = 0;
+    for (int k = 0; k < 8; k++) // The border ring is blocked, so no bounds checks
     {
-        return 0;
+        int n = id + offsets[k];
+        if ( !blocked.test( n ) )
+            out[amount++] = n;
     }
-
-    return &map_data[ y * map_size.width + x ];
+    return amount;
 }
 
 // -----------------------------------------------------------------------
 
-std::vector<Map_Node *> A_Star::neighbors(const Map_Node *node)
+bool A_Star::walkable(const int id) { return !blocked.test( id ); }
+
+// -----------------------------------------------------------------------
+
+int A_Star::jump(int id, const int dx, const int dy)
 {
-    std::vector<Map_Node *> available;
-    Map_Node *_node;
+    const int step = dy * stride + dx;
+    while ( true )
+    {
+        id += step;
+        if ( !walkable( id ) )
+            return -1;
 
-    // L
-    _node = map_at( node->x-1, node->y );
-    if ( _node != 0 )
-        available.push_back( _node );
+        if ( id == goal_index )
+            return id;
 
-    // T
-    _node = map_at( node->x, node->y-1 );
-    if ( _node != 0 )
-        available.push_back( _node );
+        if ( dx != 0 && dy != 0 ) // Diagonal
+        {
+            if ( ( !walkable( id - dx ) && walkable( id - dx + dy * stride ) ) ||
+                 ( !walkable( id - dy * stride ) && walkable( id + dx - dy * stride ) ) )
+                return id; // Forced neighbor
 
-    // R
-    _node = map_at( node->x+1, node->y );
-    if ( _node != 0 )
-        available.push_back( _node );
+            if ( jump( id, dx, 0 ) >= 0 || jump( id, 0, dy ) >= 0 )
+                return id; // A straight jump from here finds something
+        }
+        else if ( dx != 0 ) // Horizontal
+        {
+            if ( ( !walkable( id + stride ) && walkable( id + stride + dx ) ) ||
+                 ( !walkable( id - stride ) && walkable( id - stride + dx ) ) )
+                return id;
+        }
+        else // Vertical
+        {
+            if ( ( !walkable( id + 1 ) && walkable( id + 1 + dy * stride ) ) ||
+                 ( !walkable( id - 1 ) && walkable( id - 1 + dy * stride ) ) )
+                return id;
+        }
+    }
+}
 
-    // B
-    _node = map_at( node->x, node->y+1 );
-    if ( _node != 0 )
-        available.push_back( _node );
+// -----------------------------------------------------------------------
 
-    // LT
-    _node = map_at( node->x-1, node->y-1 );
-    if ( _node != 0 )
-        available.push_back( _node );
+int A_Star::jump_successors(const int id, int *out)
+{
+    int directions[8][2];
+    int amount = 0;
 
-    // RT
-    _node = map_at( node->x+1, node->y-1 );
-    if ( _node != 0 )
-        available.push_back( _node );
+    if ( id == start_index ) // Start node => all directions, same order as neighbors()
+    {
+        static const int all[8][2] = { {-1,0}, {0,-1}, {1,0}, {0,1},
+                                       {-1,-1}, {1,-1}, {1,1}, {-1,1} };
+        for ( auto& d : all )
+        {
+            directions[amount][0] = d[0];
+            directions[amount++][1] = d[1];
+        }
+    }
+    else
+    {
+        // Direction of travel, the parent can be several pixels away
+        int x = id % stride, y = id / stride;
+        int px = parent[id] % stride, py = parent[id] / stride;
+        int dx = ( x > px ) - ( x < px );
+        int dy = ( y > py ) - ( y < py );
+        auto add = [&]( const int ddx, const int ddy )
+        {
+            directions[amount][0] = ddx;
+            directions[amount++][1] = ddy;
+        };
 
-    // RB
-    _node = map_at( node->x+1, node->y+1 );
-    if ( _node != 0 )
-        available.push_back( _node );
+        if ( dx != 0 && dy != 0 )
+        {
+            add( dx, 0 );
+            add( 0, dy );
+            add( dx, dy );
+            if ( !walkable( id - dx ) )
+                add( -dx, dy );
+            if ( !walkable( id - dy * stride ) )
+                add( dx, -dy );
+        }
+        else if ( dx != 0 )
+        {
+            add( dx, 0 );
+            if ( !walkable( id + stride ) )
+                add( dx, 1 );
+            if ( !walkable( id - stride ) )
+                add( dx, -1 );
+        }
+        else
+        {
+            add( 0, dy );
+            if ( !walkable( id + 1 ) )
+                add( 1, dy );
+            if ( !walkable( id - 1 ) )
+                add( -1, dy );
+        }
+    }
 
-    // LB
-    _node = map_at( node->x-1, node->y+1 );
-    if ( _node != 0 )
-        available.push_back( _node );
+    int found = 0;
+    for (int i = 0; i < amount; i++)
+    {
+        int n = jump( id, directions[i][0], directions[i][1] );
+        if ( n >= 0 )
+            out[found++] = n;
+    }
 
-    return available;
+    return found;
 }
 
 // -----------------------------------------------------------------------
 
-std::vector<Map_Node *> A_Star::find()
+template<class Observer>
+std::vector<cv::Point> A_Star::find(Observer &observer)
 {
-    vector<Map_Node *> path;
-    Map_Node *node, *reversed_ptr = 0;
-    while ( open_list.size() > 0 )
-    {
-        node = open_list.at(0); // Default value
-        for ( auto& n : open_list)
-        {
-            if ( ( n->f() <= node->f() ) ) // Find a better choice
-                node = n;
-        }
-        open_list.erase( remove( open_list.begin(), open_list.end(), node ), open_list.end() );
+    vector<cv::Point> path;
+    int successors[8];
+    bool found = false;
 
-        node->flag = NODE_FLAG_CLOSED;
+    g[start_index] = 0;
+    open_list->push( start_index, 0, 0 );
 
-        if ( node == goal_node )
+    while ( !open_list->empty() )
+    {
+        int id = open_list->pop(); // Lowest f
+        closed.set( id );
+        observer.on_expand( point_of( id ) );
+
+        if ( id == goal_index )
         {
-            reversed_ptr = node;
+            found = true;
             break;
         }
 
-        vector<Map_Node *> neighbor_nodes = neighbors( node );
-
-        for ( auto& n : neighbor_nodes )
+        int amount = ( expansion_mode == EXPANSION_JUMP_POINTS ) ? jump_successors( id, successors )
+                                                                 : neighbors( id, successors );
+        for (int k = 0; k < amount; k++)
         {
-            if ( ( n->flag == NODE_FLAG_CLOSED ) ||
-                 ( n->type == NODE_TYPE_OBSTACLE ) )
+            int n = successors[k];
+            if ( closed.test( n ) ) // Obstacles are never returned as successors
                 continue;
 
-            int g = node->g + compute_g( n, node);
+            int new_g = g[id] + compute_g( n, id );
+            bool seen = ( g[n] != G_UNSEEN );
 
-            if ( ( n->flag == NODE_FLAG_UNDEFINED ) || ( g < n->g ) )
+            if ( !seen || new_g < g[n] )
             {
-                n->g = g;
-                n->h = compute_h( n, goal_node );
-                n->parent = node;
+                int h = compute_h( n, goal_index );
+                g[n] = new_g;
+                parent[n] = id;
 
-                if ( n->flag != NODE_FLAG_OPEN )
+                if ( !seen )
                 {
-                    n->flag = NODE_FLAG_OPEN;
-                    open_list.push_back( n );
+                    open_list->push( n, new_g + h, h );
+                    observer.on_open( point_of( n ) );
+                }
+                else
+                {
+                    open_list->decrease( n, new_g + h, h );
                 }
             }
         }
+    }
+    if ( !found ) // Havent found goal
+    {
+        //cout << "Target node is unreachable." << endl;
+    }
+    else
+    {
+        path = trace_path();
+    }
+    return path;
+
+}
+
+// -----------------------------------------------------------------------
+
+std::vector<cv::Point> A_Star::trace_path()
+{
+    vector<cv::Point> path;
+    for (int id = goal_index; id != start_index; id = parent[id]) // Going back through parent
+    {
+        // Jump points are several pixels apart, fill in the straight or diagonal line between them
+        int x = id % stride, y = id / stride;
+        int px = parent[id] % stride, py = parent[id] / stride;
+        int step = ( ( py > y ) - ( py < y ) ) * stride + ( px > x ) - ( px < x );
+        for (int n = id; n != parent[id]; n += step)
+            path.push_back( point_of( n ) );
+    }
+
+    reverse( path.begin(), path.end() );
+    return path;
+}
+
+// -----------------------------------------------------------------------
+// Anytime search
+// -----------------------------------------------------------------------
+
+void A_Star::set_anytime_epsilon( const double start, const double step )
+{
+    anytime_epsilon = max( start, 1.0 );
+    anytime_step = step;
+}
 
-        draw_open_list();
+// -----------------------------------------------------------------------
 
-        if ( open_list.size() <= 0 )
+Anytime_Result A_Star::get_anytime_path(const cv::Mat &img,
+                                        const cv::Point &start,
+                                        const cv::Point &goal,
+                                        const double budget_ms,
+                                        const bool floor_plan,
+                                        const std::function<void( const Anytime_Result & )> &on_solution)
+{
+    auto begin = chrono::steady_clock::now();
+    auto deadline = begin + chrono::duration_cast<chrono::steady_clock::duration>( chrono::duration<double, milli>( budget_ms ) );
+
+    load_map( img, start, goal, floor_plan );
+    anytime_open.reserve( g.size() );
+    inconsistent.assign( g.size(), false );
+    incons.clear();
+    touched.clear();
+
+    Anytime_Result result;
+    double epsilon = anytime_epsilon;
+    g[start_index] = 0;
+    touched.push_back( start_index );
+    anytime_open.push( start_index, 0 );
+
+    while ( true )
+    {
+        long long epsilon_m = llround( epsilon * 1000 );
+        if ( !improve_path( epsilon_m, deadline, result.iterations > 0 ) )
+            break; // Out of time, keep the last path
+
+        result.iterations++;
+        if ( g[goal_index] == G_UNSEEN ) // Unreachable, a lower epsilon wont change that
+            break;
+
+        result.path = trace_path();
+        result.epsilon = anytime_bound( epsilon );
+        result.elapsed_ms = chrono::duration<double, milli>( chrono::steady_clock::now() - begin ).count();
+        if ( on_solution )
+            on_solution( result );
+
+        if ( result.epsilon <= 1.0 || anytime_step <= 0 || chrono::steady_clock::now() >= deadline )
             break;
 
+        // Next epsilon: the inconsistent nodes join the open list and all keys are recomputed
+        epsilon = max( 1.0, min( epsilon, result.epsilon ) - anytime_step );
+        epsilon_m = llround( epsilon * 1000 );
+        for ( auto& id : incons )
+        {
+            inconsistent.reset( id );
+            anytime_open.push( id, 0 );
+        }
+        incons.clear();
+        for ( auto& id : touched )
+            if ( anytime_open.contains( id ) )
+                anytime_open.push( id, g[id] * 1000LL + epsilon_m * compute_g( id, goal_index ) );
+        closed.clear();
     }
-    if ( reversed_ptr == 0 ) // Havent found goal
+
+    result.elapsed_ms = chrono::duration<double, milli>( chrono::steady_clock::now() - begin ).count();
+    return result;
+}
+
+// -----------------------------------------------------------------------
+
+bool A_Star::improve_path(const long long epsilon_m,
+                          const std::chrono::steady_clock::time_point &deadline,
+                          const bool interruptible)
+{
+    int successors[8];
+    long long expansions = 0;
+
+    // Until the goal has the lowest f = g + epsilon * h, the goal key is g( goal ) * 1000
+    while ( !anytime_open.empty() &&
+            ( g[goal_index] == G_UNSEEN || anytime_open.top_key() < g[goal_index] * 1000LL ) )
     {
-        //cout << "Target node is unreachable." << endl;
+        if ( interruptible && ( ++expansions & 255 ) == 0 && chrono::steady_clock::now() >= deadline )
+            return false;
+
+        int id = anytime_open.pop();
+        closed.set( id );
+
+        int amount = neighbors( id, successors );
+        for (int k = 0; k < amount; k++)
+        {
+            int n = successors[k];
+            int new_g = g[id] + compute_g( n, id );
+            if ( g[n] != G_UNSEEN && new_g >= g[n] )
+                continue;
+
+            if ( g[n] == G_UNSEEN )
+                touched.push_back( n );
+            g[n] = new_g;
+            parent[n] = id;
+
+            if ( !closed.test( n ) )
+                anytime_open.push( n, new_g * 1000LL + epsilon_m * compute_g( n, goal_index ) );
+            else if ( !inconsistent.test( n ) ) // Expanded already with a higher g
+            {
+                inconsistent.set( n );
+                incons.push_back( n );
+            }
+        }
     }
-    else
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+double A_Star::anytime_bound( const double epsilon )
+{
+    long long lowest = LLONG_MAX;
+    for ( auto& id : touched )
+        if ( anytime_open.contains( id ) || inconsistent.test( id ) )
+            lowest = min( lowest, (long long)g[id] + compute_g( id, goal_index ) );
+
+    if ( lowest == LLONG_MAX || lowest == 0 ) // Nothing left that could lead to a shorter path
+        return 1.0;
+    return min( epsilon, max( 1.0, (double)g[goal_index] / lowest ) );
+}
+
+// -----------------------------------------------------------------------
+// Any-angle search
+// -----------------------------------------------------------------------
+
+std::vector<cv::Point> A_Star::get_any_angle_path(const cv::Mat &floor_plan,
+                                                  const cv::Point &start,
+                                                  const cv::Point &goal)
+{
+    load_map( floor_plan, start, goal, true );
+    any_angle_sight.set_map( floor_plan, Scalar(0,0,0) );
+    any_angle_open.reserve( g.size() );
+
+    // The parent of a node is any node it can see, not only a neighbor
+    auto visible = [&]( const int a, const int b ) { return any_angle_sight.visible( point_of( a ), point_of( b ) ); };
+
+    int successors[8];
+    bool found = false;
+    g[start_index] = 0;
+    parent[start_index] = start_index;
+    any_angle_open.push( start_index, euclidean_cost( start_index, goal_index ) );
+
+    while ( !any_angle_open.empty() )
     {
-        Map_Node *_node = reversed_ptr;
+        int id = any_angle_open.pop();
 
-        while ( _node->parent != 0 ) // Going back through parent
+        // Lazy Theta*: the line to the parent is only checked now, if it is blocked take the best closed neighbor
+        if ( parent[id] != id && !visible( parent[id], id ) )
         {
-            path.push_back( _node );
-            _node = _node->parent;
+            int best = G_UNSEEN;
+            int amount = neighbors( id, successors );
+            for (int k = 0; k < amount; k++)
+            {
+                int n = successors[k];
+                if ( closed.test( n ) && g[n] + euclidean_cost( n, id ) < best )
+                {
+                    best = g[n] + euclidean_cost( n, id );
+                    parent[id] = n;
+                }
+            }
+            g[id] = best;
         }
 
-        reverse( path.begin(), path.end() );
+        if ( id == goal_index )
+        {
+            found = true;
+            break;
+        }
+        closed.set( id );
+
+        int amount = neighbors( id, successors );
+        for (int k = 0; k < amount; k++)
+        {
+            int n = successors[k];
+            if ( closed.test( n ) )
+                continue;
+
+            // Assume the parent of id sees n, checked when n is expanded
+            int new_g = g[ parent[id] ] + euclidean_cost( parent[id], n );
+            if ( new_g < g[n] )
+            {
+                g[n] = new_g;
+                parent[n] = parent[id];
+                any_angle_open.push( n, new_g + euclidean_cost( n, goal_index ) );
+            }
+        }
     }
+
+    std::vector<cv::Point> path;
+    if ( !found ) // Havent found goal
+        return path;
+
+    for (int id = goal_index; id != start_index; id = parent[id])
+        path.push_back( point_of( id ) );
+    reverse( path.begin(), path.end() );
+
+    draw_path( path );
+
     return path;
+}
+
+// -----------------------------------------------------------------------
 
+int A_Star::euclidean_cost(const int id1, const int id2)
+{
+    int dx = id1 % stride - id2 % stride;
+    int dy = id1 / stride - id2 / stride;
+    return (int)lround( G_DIRECT * sqrt( (double)( dx * dx + dy * dy ) ) );
+}
+
+// -----------------------------------------------------------------------
+
+std::vector<cv::Point> A_Star::pull_string(const Line_Of_Sight &sight,
+                                           const cv::Point &start,
+                                           const std::vector<cv::Point> &path)
+{
+    // Skip every point that the last kept corner can see past
+    std::vector<cv::Point> corners;
+    cv::Point anchor = start;
+    for (size_t i = 1; i < path.size(); i++)
+    {
+        if ( !sight.visible( anchor, path[i] ) )
+        {
+            corners.push_back( path[i-1] );
+            anchor = path[i-1];
+        }
+    }
+    if ( !path.empty() )
+        corners.push_back( path.back() );
+    return corners;
 }
 
 // -----------------------------------------------------------------------
 
-void A_Star::draw_path(const std::vector<Map_Node *> path )
+double A_Star::euclidean_length(const cv::Point &start, const std::vector<cv::Point> &path)
 {
-    for ( auto& n : path )
-        map_a_star.at<Vec3b>( n->y, n->x ) = Vec3b(0,0,255);
+    double length = 0;
+    cv::Point last = start;
+    for ( auto& p : path )
+    {
+        length += cv::norm( p - last );
+        last = p;
+    }
+    return length;
 }
 
+// -----------------------------------------------------------------------
+
 vector<Point> A_Star::calculateRoadmapPoints(Mat roadmap)
 {
     // Finds all roadmap points
@@ -260,6 +771,7 @@ vector<Point> A_Star::calculateRoadmapPoints(Mat roadmap)
 
 vector<Point> A_Star::calculateTestPoints(Mat roadmap, vector<Point> roadmapPoints)
 {
+    Line_Of_Sight sight(roadmap); // Obstacle mask built once for all lines
     vector<Point> testPoints;
     for(int i = 0; i < roadmap.rows; i++)
     {
@@ -267,8 +779,8 @@ vector<Point> A_Star::calculateTestPoints(Mat roadmap, vector<Point> roadmapPoin
         {
             if(roadmap.at<Vec3b>(i, j) != Vec3b(0,0,0)) // If black pixel inside obstacle find new start point
             {
-                Point startPointOnRoadmap = findWayToRoadMap(roadmap, roadmapPoints, Point(j,i));
-                if(startPointOnRoadmap != Point(NULL, NULL)) // Have not found a starting point without obstacle to roadmap
+                Point startPointOnRoadmap = findWayToRoadMap(sight, roadmapPoints, Point(j,i));
+                if(startPointOnRoadmap != Point(-1, -1)) // Have not found a starting point without obstacle to roadmap
                     testPoints.push_back(Point(j,i));
             }
         }
@@ -278,19 +790,31 @@ vector<Point> A_Star::calculateTestPoints(Mat roadmap, vector<Point> roadmapPoin
 
 vector<Point> A_Star::checkInvalidTestPoints(Mat roadmap, vector<Point> roadmapPoints, vector<Point> checkpoints)
 {
+    Line_Of_Sight sight(roadmap); // Obstacle mask built once for all lines
     vector<Point> testPoints;
     for(size_t i = 0; i < checkpoints.size(); i++)
     {
         if(roadmap.at<Vec3b>(checkpoints[i]) != Vec3b(0,0,0)) // If black pixel inside obstacle find new start point
         {
-            Point startPointOnRoadmap = findWayToRoadMap(roadmap, roadmapPoints, checkpoints[i]);
-            if(startPointOnRoadmap != Point(NULL, NULL)) // Have not found a starting point without obstacle to roadmap
+            Point startPointOnRoadmap = findWayToRoadMap(sight, roadmapPoints, checkpoints[i]);
+            if(startPointOnRoadmap != Point(-1, -1)) // Have not found a starting point without obstacle to roadmap
                 testPoints.push_back(checkpoints[i]);
         }
     }
     return testPoints;
 }
 
+vector<Point> A_Star::checkInvalidTestPoints(Mat roadmap, const Roadmap_Snap_Field &snapField, vector<Point> checkpoints)
+{
+    vector<Point> testPoints;
+    for(size_t i = 0; i < checkpoints.size(); i++)
+    {
+        if(roadmap.at<Vec3b>(checkpoints[i]) != Vec3b(0,0,0) && snapField.has_snap(checkpoints[i])) // One lookup instead of a line to every roadmap point
+            testPoints.push_back(checkpoints[i]);
+    }
+    return testPoints;
+}
+
 vector<Point> A_Star::findNRemoveDiff(vector<Point> testPoint1, vector<Point> testPoint2)
 {
     vector<Point> correct;
@@ -316,6 +840,9 @@ vector<double> A_Star::findAstarPathLengthsForRoadmap(Mat roadmap) // takes too
     vector<double> pathLengths;
     double tempDist;
     vector<Point> aStarPath;
+    vector<pair<Point, Point>> queries;
+    Roadmap_Graph roadmapGraph(roadmap); // Extracted once, searched for every query
+    Line_Of_Sight sight(roadmap); // Obstacle mask built once for all lines
     Point startPointOnRoadmap;
     Point endPointOnRoadmap;
 
@@ -334,8 +861,8 @@ vector<double> A_Star::findAstarPathLengthsForRoadmap(Mat roadmap) // takes too
         {
             if(roadmap.at<Vec3b>(i, j) != Vec3b(0,0,0)) // If black pixel inside obstacle find new start point
             {
-                startPointOnRoadmap = findWayToRoadMap(roadmap, roadmapPoints, Point(j,i));
-                if(startPointOnRoadmap != Point(NULL, NULL)) // Have not found a starting point without obstacle to roadmap
+                startPointOnRoadmap = findWayToRoadMap(sight, roadmapPoints, Point(j,i));
+                if(startPointOnRoadmap != Point(-1, -1)) // Have not found a starting point without obstacle to roadmap
                     testPoints.push_back(Point(j,i));
             }
         }
@@ -352,20 +879,19 @@ vector<double> A_Star::findAstarPathLengthsForRoadmap(Mat roadmap) // takes too
         //cout << "MiddlePoint: " << testPoints.size() / 2 << " Start: " << indexStart << endl;
         testPointStart = testPoints[indexStart];
         testPointEnd = testPoints[indexEnd];
-        startPointOnRoadmap = findWayToRoadMap(roadmap, roadmapPoints, testPointStart);
-        endPointOnRoadmap = findWayToRoadMap(roadmap, roadmapPoints, testPointEnd);
+        startPointOnRoadmap = findWayToRoadMap(sight, roadmapPoints, testPointStart);
+        endPointOnRoadmap = findWayToRoadMap(sight, roadmapPoints, testPointEnd);
         if(startPointOnRoadmap != endPointOnRoadmap)
         {
             tempDist = 0;
-            aStarPath = get_path(roadmap, startPointOnRoadmap, endPointOnRoadmap);
             //tempDist = calculateDiagonalDist(testPointStart, startPointOnRoadmap); // From start to start on roadmap
             //tempDist += calculateDiagonalDist(testPointEnd, endPointOnRoadmap); // From goal to goal on roadmap
             LineIterator itStart(roadmap, testPointStart, startPointOnRoadmap); // From start to start on roadmap
             LineIterator itEnd(roadmap, testPointEnd, endPointOnRoadmap); // From goal to goal on roadmap
             tempDist += itStart.count;
             tempDist += itEnd.count;
-            tempDist += aStarPath.size(); // Path length of astar
             pathLengths.push_back(tempDist);
+            queries.push_back(make_pair(startPointOnRoadmap, endPointOnRoadmap)); // Searched together below
             // Go towards each other
             indexStart++;
             indexEnd--;
@@ -380,15 +906,21 @@ vector<double> A_Star::findAstarPathLengthsForRoadmap(Mat roadmap) // takes too
             indexEnd--;
         }
     }
+
+    // Path length of astar, all queries spread over the cores
+    Thread_Pool pool;
+    vector<vector<Point>> aStarPaths = get_paths(roadmapGraph, queries, pool);
+    for(size_t i = 0; i < pathLengths.size(); i++)
+        pathLengths[i] += aStarPaths[i].size();
     /*
     for(size_t i = 0; i < testPoints.size() ; i++)
     {
-        startPointOnRoadmap = findWayToRoadMap(roadmap, roadmapPoints, testPoints[i]);
+        startPointOnRoadmap = findWayToRoadMap(sight, roadmapPoints, testPoints[i]);
         cout << i << endl;
         for(size_t j = i + 1; j < testPoints.size() -1 ; j++)
         {
             cout << j << endl;
-            endPointOnRoadmap = findWayToRoadMap(roadmap, roadmapPoints, testPoints[j]);
+            endPointOnRoadmap = findWayToRoadMap(sight, roadmapPoints, testPoints[j]);
             if(startPointOnRoadmap == endPointOnRoadmap)
                 continue;
             tempDist = 0;
@@ -408,12 +940,13 @@ vector<double> A_Star::findAstarPathLengthsForRoadmap(Mat roadmap) // takes too
 
 Mat A_Star::showPath(Mat smallworld, Mat roadmap, vector<Point> roadmapPoints, Point startPoints, Point endPoints)
 {
+    Line_Of_Sight sight(roadmap); // Obstacle mask built once for all lines
     Mat tempMap = smallworld.clone();
     Point startPointOnRoadmap;
     Point endPointOnRoadmap;
     vector<Point> aStarPath;
     double tempDist = 0;
-    if( !obstacleDetectedWithLine( roadmap, startPoints, endPoints ) )// Direct path no use of A_Star
+    if( sight.visible( startPoints, endPoints ) )// Direct path no use of A_Star
     {
         //line(tempMap, startPoints, endPoints, Scalar(0,0,255), 1, 8, 0); // Draw line from start point to start point on graph
         // For checking Distance
@@ -428,8 +961,8 @@ Mat A_Star::showPath(Mat smallworld, Mat roadmap, vector<Point> roadmapPoints, P
     }
     else
     {
-        startPointOnRoadmap = findWayToRoadMap(roadmap, roadmapPoints, startPoints);
-        endPointOnRoadmap = findWayToRoadMap(roadmap, roadmapPoints, endPoints);
+        startPointOnRoadmap = findWayToRoadMap(sight, roadmapPoints, startPoints);
+        endPointOnRoadmap = findWayToRoadMap(sight, roadmapPoints, endPoints);
         if(startPointOnRoadmap != endPointOnRoadmap)
         {
             aStarPath = get_path(roadmap, startPointOnRoadmap, endPointOnRoadmap);
@@ -461,15 +994,17 @@ Mat A_Star::showPath(Mat smallworld, Mat roadmap, vector<Point> roadmapPoints, P
 
 vector<double> A_Star::findAstarPathLengthsForRoadmapRandom(Mat roadmap, vector<Point> roadmapPoints, vector<Point> startPoints, vector<Point> endPoints)
 {
+    Line_Of_Sight sight(roadmap); // Obstacle mask built once for all lines
     vector<double> pathLengths;
     vector<Point> aStarPath;
+    Roadmap_Graph roadmapGraph(roadmap); // Extracted once, searched for every query
     Point startPointOnRoadmap, endPointOnRoadmap;
     double tempDist = 0;
     for(size_t i = 0; i < startPoints.size(); i++)
     {
         tempDist = 0;
         aStarPath.clear();
-        if( !obstacleDetectedWithLine( roadmap, startPoints[i], endPoints[i] ) )// Direct path no use of A_Star
+        if( sight.visible( startPoints[i], endPoints[i] ) )// Direct path no use of A_Star
         {
             LineIterator it( roadmap, startPoints[i], endPoints[i], 8 );
             std::vector<cv::Point> lines( it.count );
@@ -480,11 +1015,11 @@ vector<double> A_Star::findAstarPathLengthsForRoadmapRandom(Mat roadmap, vector<
         }
         else
         {
-            startPointOnRoadmap = findWayToRoadMap(roadmap, roadmapPoints, startPoints[i]);
-            endPointOnRoadmap = findWayToRoadMap(roadmap, roadmapPoints, endPoints[i]);
+            startPointOnRoadmap = findWayToRoadMap(sight, roadmapPoints, startPoints[i]);
+            endPointOnRoadmap = findWayToRoadMap(sight, roadmapPoints, endPoints[i]);
             if(startPointOnRoadmap != endPointOnRoadmap)
             {
-                aStarPath = get_path(roadmap, startPointOnRoadmap, endPointOnRoadmap);
+                roadmapGraph.find_path(startPointOnRoadmap, endPointOnRoadmap, aStarPath);
                 //tempDist = calculateDiagonalDist(startPoints[i], startPointOnRoadmap); // From start to start on roadmap
                 //tempDist += calculateDiagonalDist(endPoints[i], endPointOnRoadmap); // From goal to goal on roadmap
                 LineIterator itStart(roadmap, startPoints[i], startPointOnRoadmap); // From start to start on roadmap
@@ -509,38 +1044,124 @@ vector<double> A_Star::findAstarPathLengthsForRoadmapRandom(Mat roadmap, vector<
     return pathLengths;
 }
 
-vector<double> A_Star::getResults()
+vector<double> A_Star::findAstarPathLengthsForRoadmapRandom(Mat roadmap, vector<Point> roadmapPoints, vector<Point> startPoints, vector<Point> endPoints, const Roadmap_Distance_Table &distanceTable)
 {
-    return results;
+    Line_Of_Sight sight(roadmap); // Obstacle mask built once for all lines
+    return findAstarPathLengthsForSnappedPoints(roadmap, sight, startPoints, endPoints, distanceTable,
+                                                [&](const Point &p) { return findWayToRoadMap(sight, roadmapPoints, p); });
 }
 
-// -----------------------------------------------------------------------
+vector<double> A_Star::findAstarPathLengthsForRoadmapRandom(Mat roadmap, vector<Point> startPoints, vector<Point> endPoints, const Roadmap_Distance_Table &distanceTable, const Roadmap_Snap_Field &snapField)
+{
+    Line_Of_Sight sight(roadmap);
+    return findAstarPathLengthsForSnappedPoints(roadmap, sight, startPoints, endPoints, distanceTable,
+                                                [&](const Point &p) { return snapField.snap(p); });
+}
 
-void A_Star::draw_open_list() 
+vector<double> A_Star::findAstarPathLengthsForSnappedPoints(Mat roadmap, const Line_Of_Sight &sight, const vector<Point> &startPoints, const vector<Point> &endPoints, const Roadmap_Distance_Table &distanceTable, const std::function<Point(const Point &)> &snap)
 {
-    for ( auto& o : open_list ) 
+    vector<double> pathLengths;
+    int roadmapCost, roadmapSteps;
+    Point startPointOnRoadmap, endPointOnRoadmap;
+    double tempDist = 0;
+    for(size_t i = 0; i < startPoints.size(); i++)
     {
-        Map_Node *n = o;
-      
-        if ( ( n == start_node ) || ( n == goal_node ) )
-            continue;
-      
-        map_a_star.at<Vec3b>(n->y, n->x) = Vec3b(210,210,210);
+        tempDist = 0;
+        if( sight.visible( startPoints[i], endPoints[i] ) )// Direct path no use of A_Star
+        {
+            LineIterator it( roadmap, startPoints[i], endPoints[i], 8 );
+            std::vector<cv::Point> lines( it.count );
+            for (int i = 0; i < it.count; i++, it++)
+                lines.push_back( Point( it.pos() ) );
+            tempDist = lines.size();
+            pathLengths.push_back(tempDist);
+        }
+        else
+        {
+            startPointOnRoadmap = snap(startPoints[i]);
+            endPointOnRoadmap = snap(endPoints[i]);
+            if(startPointOnRoadmap != endPointOnRoadmap)
+            {
+                roadmapSteps = 0;
+                distanceTable.path_length(startPointOnRoadmap, endPointOnRoadmap, roadmapCost, roadmapSteps); // Table lookup instead of a search
+                //tempDist = calculateDiagonalDist(startPoints[i], startPointOnRoadmap); // From start to start on roadmap
+                //tempDist += calculateDiagonalDist(endPoints[i], endPointOnRoadmap); // From goal to goal on roadmap
+                LineIterator itStart(roadmap, startPoints[i], startPointOnRoadmap); // From start to start on roadmap
+                LineIterator itEnd(roadmap, endPoints[i], endPointOnRoadmap); // From goal to goal on roadmap
+                tempDist += itStart.count;
+                tempDist += itEnd.count;
+                tempDist += roadmapSteps; // Path length on the roadmap
+                pathLengths.push_back(tempDist);
+            }
+            else // If equal to eachother the aStarPath = 0
+            {
+                //tempDist = calculateDiagonalDist(startPoints[i], startPointOnRoadmap); // From start to start on roadmap
+                //tempDist += calculateDiagonalDist(endPoints[i], endPointOnRoadmap); // From goal to goal on roadmap
+                LineIterator itStart(roadmap, startPoints[i], startPointOnRoadmap); // From start to start on roadmap
+                LineIterator itEnd(roadmap, endPoints[i], endPointOnRoadmap); // From goal to goal on roadmap
+                tempDist += itStart.count;
+                tempDist += itEnd.count;
+                pathLengths.push_back(tempDist);
+            }
+        }
     }
+    return pathLengths;
+}
+
+vector<double> A_Star::getResults()
+{
+    return results;
 }
 
 // -----------------------------------------------------------------------
 
 Mat A_Star::get_a_star() { return map_a_star; }
 
+// -----------------------------------------------------------------------
+
+void A_Star::draw_path( const std::vector<cv::Point> &path )
+{
+    if ( !map_a_star.empty() )
+        for ( auto& p : path )
+            map_a_star.at<Vec3b>( p ) = Vec3b(0,0,255);
+}
+
 
 Point A_Star::findWayToRoadMap(Mat roadmap, vector<Point> roadmapPoints, Point entryExitPoint)
 {
-    Point roadmapEntryExit = Point(NULL, NULL);
+    Point roadmapEntryExit = Point(-1, -1);
     bool first = true;
     for(size_t i = 0; i < roadmapPoints.size(); i++)
     {
-        if(!obstacleDetectedWithLine(roadmap, roadmapPoints[i], entryExitPoint))
+        if(!obstacleDetectedWithLine(roadmap, roadmapPoints[i], entryExitPoint)) // Walks the Mat, no mask for a single call
+        {
+            if(first)
+            {
+                roadmapEntryExit = roadmapPoints[i];
+                first = false;
+            }
+            else
+            {
+                if(calculateDiagonalDist(roadmapEntryExit, entryExitPoint) >= calculateDiagonalDist(roadmapPoints[i], entryExitPoint))
+                    roadmapEntryExit = roadmapPoints[i];
+            }
+        }
+    }
+    return roadmapEntryExit;
+}
+
+Point A_Star::findWayToRoadMap(const Roadmap_Snap_Field &snapField, Point entryExitPoint)
+{
+    return snapField.snap(entryExitPoint);
+}
+
+Point A_Star::findWayToRoadMap(const Line_Of_Sight &sight, const vector<Point> &roadmapPoints, Point entryExitPoint)
+{
+    Point roadmapEntryExit = Point(-1, -1);
+    bool first = true;
+    for(size_t i = 0; i < roadmapPoints.size(); i++)
+    {
+        if(sight.visible(roadmapPoints[i], entryExitPoint)) // From the roadmap like the LineIterator loop
         {
             if(first)
             {
@@ -564,8 +1185,9 @@ double A_Star::calculateDiagonalDist(Point p1, Point p2)
 
 
 
-void A_Star::calculateDistThread(Mat roadmap, vector<Point> testPoints, vector<Point> roadmapPoints, int threadNumber, int amountOfThreads) // is not used because of threads in qt
+void A_Star::calculateDistThread(Mat roadmap, vector<Point> testPoints, vector<Point> roadmapPoints, int threadNumber, int amountOfThreads) // is not used because of threads in qt, see get_paths
 {
+    Line_Of_Sight sight(roadmap); // Obstacle mask built once for all lines
     int amount = testPoints.size()/amountOfThreads;
     int start = amount*(threadNumber -1);
     int stop = amount*(threadNumber);
@@ -573,6 +1195,7 @@ void A_Star::calculateDistThread(Mat roadmap, vector<Point> testPoints, vector<P
     Point endPointOnRoadmap;
     int tempDist = 0;
     vector<Point> aStarPath;
+    Roadmap_Graph roadmapGraph(roadmap); // Extracted once, searched for every query
     int percentDone = 0;
     cout << "ThreadNumber: " << threadNumber << " start: " << start << " stop: " << stop << " amount: " << amount << endl;
     string file = "Results_Thread_" + to_string(threadNumber) + ".txt";
@@ -582,16 +1205,16 @@ void A_Star::calculateDistThread(Mat roadmap, vector<Point> testPoints, vector<P
     {
         cout << "Tread Number: " << threadNumber << " Percent done: " << (int)(((double)percentDone/(double)amount)*100) << endl;
         percentDone++;
-        startPointOnRoadmap = findWayToRoadMap(roadmap, roadmapPoints, testPoints[i]);
+        startPointOnRoadmap = findWayToRoadMap(sight, roadmapPoints, testPoints[i]);
         for(size_t j = i + 1; j < testPoints.size() ; j++)
         {
 
-            endPointOnRoadmap = findWayToRoadMap(roadmap, roadmapPoints, testPoints[j]);
+            endPointOnRoadmap = findWayToRoadMap(sight, roadmapPoints, testPoints[j]);
 
             if(startPointOnRoadmap == endPointOnRoadmap)
                 continue;
             tempDist = 0;
-            aStarPath = get_path(roadmap, startPointOnRoadmap, endPointOnRoadmap);
+            roadmapGraph.find_path(startPointOnRoadmap, endPointOnRoadmap, aStarPath);
             tempDist = calculateDiagonalDist(testPoints[i], startPointOnRoadmap); // From start to start on roadmap
             tempDist += calculateDiagonalDist(testPoints[j], endPointOnRoadmap); // From goal to goal on roadmap
             tempDist += aStarPath.size(); // Path length of astar
@@ -604,24 +1227,17 @@ void A_Star::calculateDistThread(Mat roadmap, vector<Point> testPoints, vector<P
     myFile.close();
 }
 
-vector<Point> A_Star::get_points(LineIterator &it)
-{
-    vector<Point> v(it.count);
-    for (int i = 0; i < it.count; i++, it++) {
-        v[i] = it.pos();
-    }
-    return v;
-}
-
 bool A_Star::obstacleDetectedWithLine(Mat roadmap,Point start, Point end)
 {
-    LineIterator it(roadmap, start, end, 8); // 8 for diagonal
-    for (int i = 0; i < it.count; i++, it++) // next point on line
-    {
-        if ( roadmap.at<Vec3b>( it.pos() ) == Vec3b(0,0,0) )
-            return true;
-    }
-    return false;
+    return Line_Of_Sight::obstacle_on_line(roadmap, start, end, Scalar(0,0,0));
 }
 
 // -----------------------------------------------------------------------
+// The observers in Search_Observer.h
+
+template vector<Point> A_Star::get_path( const cv::Mat &, const cv::Point &, const cv::Point &, Null_Search_Observer & );
+template vector<Point> A_Star::get_path( const cv::Mat &, const cv::Point &, const cv::Point &, Draw_Search_Observer & );
+template vector<Point> A_Star::get_path( const cv::Mat &, const cv::Point &, const cv::Point &, Counting_Search_Observer & );
+template vector<Point> A_Star::get_floor_plan_path( const cv::Mat &, const cv::Point &, const cv::Point &, Null_Search_Observer & );
+template vector<Point> A_Star::get_floor_plan_path( const cv::Mat &, const cv::Point &, const cv::Point &, Draw_Search_Observer & );
+template vector<Point> A_Star::get_floor_plan_path( const cv::Mat &, const cv::Point &, const cv::Point &, Counting_Search_Observer & );
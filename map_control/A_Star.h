@@ -13,52 +13,42 @@
 #include <thread>
 #include <iostream>
 #include <vector>
+#include <memory>
+#include <chrono>
+#include <climits>
+#include <functional>
+
+#include "Open_List.h"
+#include "Bit_Plane.h"
+#include "Line_Of_Sight.h"
+#include "Search_Observer.h"
 
 using namespace std;
 using namespace cv;
 
+class Prepared_Roadmap;
+class Path_Cache;
+class Roadmap_Snap_Field;
+class Landmark_Table;
+class Roadmap_Graph;
+class Roadmap_Distance_Table;
+class Contraction_Hierarchy;
+class Navigation_Field;
+class Thread_Pool;
+
 /***************************************
  * Constants
  ***************************************/
 
 const int ALLOW_VERTEX_PASSTHROUGH = 1;
-const int DRAW_OPEN_LIST = 1;
-
-const int NODE_FLAG_CLOSED = -1;
-const int NODE_FLAG_UNDEFINED = 0;
-const int NODE_FLAG_OPEN = 1;
-
-const int NODE_TYPE_ZERO = 0;
-const int NODE_TYPE_OBSTACLE = 1;
-const int NODE_TYPE_START = 2;
-const int NODE_TYPE_END = 3;
+const int DRAW_OPEN_LIST = 1;  // Draw the open list on map_a_star in get_path
 
 const int G_DIRECT = 10;
 const int G_SKEW = 14;
+const int G_UNSEEN = INT_MAX;   // g of a cell that has not been reached
 
-class Map_Node
-{
-    public:
-        int x = -1, y = -1, h = 0, g = 0;
-        int type = NODE_TYPE_ZERO, flag = NODE_FLAG_UNDEFINED;
-        Map_Node *parent = 0;
-        Map_Node() {}
-        Map_Node(int x,
-                int y,
-                int type = NODE_TYPE_ZERO,
-                int flag = NODE_FLAG_UNDEFINED,
-                Map_Node *parent = 0) {
-            this->x = x;
-            this->y = y;
-            this->type = type;
-            this->flag = flag;
-            this->parent = parent;
-        }
-
-        int f() {
-            return g + h;
-        }
-};
+const int EXPANSION_NEIGHBORS = 0;      // All 8 neighbors of a node
+const int EXPANSION_JUMP_POINTS = 1;    // Jump Point Search, only the jump points
 
 class Map_Size
 {
@@ -76,6 +66,14 @@ class Map_Size
         }
 };
 
+struct Anytime_Result
+{
+    vector<Point> path;         // Same format as get_path, empty if none was found
+    double epsilon = 0;         // Path cost is at most epsilon * optimal cost
+    double elapsed_ms = 0;      // Time since the query started
+    int iterations = 0;         // Finished searches, one per epsilon
+};
+
 class A_Star
 {
     public:
@@ -93,100 +91,433 @@ class A_Star
                                 const cv::Point &start,
                                 const cv::Point &goal);
 
+        /**
+         * @brief get_path -> Search the topological graph of the roadmap
+         *      instead of the pixel grid. Returns the same pixel path format.
+         * @param graph => Roadmap_Graph built from the roadmap
+         * @param start => Must be a roadmap pixel
+         * @param goal => Must be a roadmap pixel
+         * @return
+         */
+        vector<Point> get_path( Roadmap_Graph &graph,
+                                const cv::Point &start,
+                                const cv::Point &goal);
+
+        /**
+         * @brief get_path -> Query a contraction hierarchy of the roadmap
+         *      graph, same result as the graph search in a fraction of
+         *      the time
+         * @param hierarchy => Built from the Roadmap_Graph of the roadmap
+         * @param start => Must be a roadmap pixel
+         * @param goal => Must be a roadmap pixel
+         * @return
+         */
+        vector<Point> get_path( Contraction_Hierarchy &hierarchy,
+                                const cv::Point &start,
+                                const cv::Point &goal);
+
+        /**
+         * @brief get_path -> Follow a navigation field to its goal, for many
+         *      starts with the same goal the field is built only once
+         * @param field => Built from the map with the goal
+         * @param start
+         * @return Same format as get_path, empty if the goal is unreachable
+         */
+        vector<Point> get_path( const Navigation_Field &field,
+                                const cv::Point &start);
+
+        /**
+         * @brief get_bidirectional_path -> Bidirectional A* on a prepared
+         *      roadmap, the frontiers from start and goal meet in the middle
+         * @param road_map => Prepared_Roadmap built from the roadmap
+         * @param start
+         * @param goal
+         * @return Optimal path in the same format as get_path
+         */
+        vector<Point> get_bidirectional_path( Prepared_Roadmap &road_map,
+                                              const cv::Point &start,
+                                              const cv::Point &goal);
+
+        /**
+         * @brief get_cached_path -> Roadmap path between the snapped entry
+         *      and exit points, looked up in the cache before searching
+         * @param road_map
+         * @param cache => Emptied automatically when road_map changes
+         * @param entry => Roadmap pixel, see findWayToRoadMap
+         * @param exit => Roadmap pixel
+         * @return Same format as get_path
+         */
+        vector<Point> get_cached_path( const Prepared_Roadmap &road_map,
+                                       Path_Cache &cache,
+                                       const cv::Point &entry,
+                                       const cv::Point &exit );
+
+        /**
+         * @brief get_paths -> Batch version of get_path on the graph. The
+         *      queries are spread over the threads of the pool and nothing
+         *      of this object is used, so it is safe to call concurrently.
+         * @param graph
+         * @param queries => ( start, goal ) pairs of roadmap pixels
+         * @param pool
+         * @return The paths in the same order as the queries, empty if
+         *      none was found
+         */
+        vector<vector<Point>> get_paths( const Roadmap_Graph &graph,
+                                         const vector<pair<Point, Point>> &queries,
+                                         Thread_Pool &pool ) const;
+
+        /**
+         * @brief get_path -> As above, but the search is reported to the
+         *      observer instead of drawn on map_a_star. Instantiated for
+         *      the observers in Search_Observer.h
+         * @param road_map
+         * @param start
+         * @param goal
+         * @param observer => Null_Search_Observer, Draw_Search_Observer
+         *      or Counting_Search_Observer
+         * @return
+         */
+        template<class Observer>
+        vector<Point> get_path( const cv::Mat &road_map,
+                                const cv::Point &start,
+                                const cv::Point &goal,
+                                Observer &observer );
+
+        /**
+         * @brief get_floor_plan_path -> Plan directly on a floor plan
+         *      without building a roadmap first
+         * @param floor_plan => Black pixels are obstacles, the rest is free
+         * @param start
+         * @param goal
+         * @return Path in the same format as get_path
+         */
+        vector<Point> get_floor_plan_path( const cv::Mat &floor_plan,
+                                           const cv::Point &start,
+                                           const cv::Point &goal);
+
+        /**
+         * @brief get_floor_plan_path -> As above, reported to the observer
+         */
+        template<class Observer>
+        vector<Point> get_floor_plan_path( const cv::Mat &floor_plan,
+                                           const cv::Point &start,
+                                           const cv::Point &goal,
+                                           Observer &observer );
+
+        /**
+         * @brief get_anytime_path -> Anytime Repairing A* ( ARA*, Likhachev
+         *      et al. 2003 ). A first path is searched with the heuristic
+         *      inflated by the start epsilon, then epsilon is lowered step by
+         *      step and the path improved while the time budget allows. The
+         *      g values and the open list are kept between the steps, only
+         *      nodes that became inconsistent are expanded again.
+         *      The first search always finishes, so a path is returned if
+         *      one exists even when it takes longer than the budget.
+         * @param img => Roadmap, or floor plan if floor_plan is true
+         * @param start
+         * @param goal
+         * @param budget_ms => Time budget for the whole query
+         * @param floor_plan => See get_floor_plan_path
+         * @param on_solution => Called with every new path, can be empty
+         * @return The best path found, its suboptimality bound and the time used
+         */
+        Anytime_Result get_anytime_path( const cv::Mat &img,
+                                         const cv::Point &start,
+                                         const cv::Point &goal,
+                                         const double budget_ms,
+                                         const bool floor_plan = false,
+                                         const std::function<void( const Anytime_Result & )> &on_solution = nullptr );
+
+        /**
+         * @brief get_any_angle_path -> Lazy Theta* ( Nash et al. 2010 ) on
+         *      a floor plan. A node may take any node it can see as parent,
+         *      so the path is a few corner waypoints joined by straight
+         *      lines instead of one waypoint per pixel.
+         * @param floor_plan => Black pixels are obstacles, the rest is free
+         * @param start
+         * @param goal
+         * @return Corner waypoints from start ( excluded ) to goal, empty
+         *      if not found. Consecutive waypoints see each other.
+         */
+        vector<Point> get_any_angle_path( const cv::Mat &floor_plan,
+                                          const cv::Point &start,
+                                          const cv::Point &goal );
+
+        /**
+         * @brief pull_string -> Reduce a pixel path to its corners, a point
+         *      is dropped when the previous corner can see the next point
+         * @param sight => Obstacles the straight lines must not cross
+         * @param start => Start of the path, not part of it
+         * @param path => Same format as get_path
+         * @return Corner waypoints in the same format, the goal included
+         */
+        static vector<Point> pull_string( const Line_Of_Sight &sight,
+                                          const cv::Point &start,
+                                          const vector<Point> &path );
+
+        /**
+         * @brief euclidean_length -> Length of the straight lines through
+         *      the points, for pixel paths and waypoint paths alike. The
+         *      pixel count of a get_path result is path.size()
+         * @param start
+         * @param path
+         * @return Length in pixels
+         */
+        static double euclidean_length( const cv::Point &start,
+                                        const vector<Point> &path );
+
+        /**
+         * @brief set_anytime_epsilon
+         * @param start => Inflation of the first search, >= 1
+         * @param step => Decrease of epsilon between the searches, > 0
+         */
+        void set_anytime_epsilon( const double start, const double step );
+
         Mat get_a_star();
 
+        /**
+         * @brief set_open_list_policy
+         * @param policy => OPEN_LIST_LINEAR, OPEN_LIST_BINARY_HEAP or OPEN_LIST_BUCKET
+         */
+        void set_open_list_policy( const int policy );
+
+        int get_open_list_policy();
+
+        /**
+         * @brief set_expansion_mode
+         * @param mode => EXPANSION_NEIGHBORS or EXPANSION_JUMP_POINTS.
+         *      Jump Point Search uses the octile distance as heuristic,
+         *      so its paths are as short as the optimal 8-connected path.
+         */
+        void set_expansion_mode( const int mode );
+
+        int get_expansion_mode();
+
+        /**
+         * @brief set_landmarks -> Use the ALT heuristic, max( octile, landmark
+         *      bound ), when the table fits the searched map. It never
+         *      overestimates, so the paths are optimal.
+         * @param landmarks => Built from the same image and mode as the
+         *      searches, not copied. nullptr = the default heuristic
+         */
+        void set_landmarks( const Landmark_Table *landmarks );
+
+        const Landmark_Table *get_landmarks();
+
         // Experiment functions
         vector<double> findAstarPathLengthsForRoadmap(Mat roadmap); // Takes too long time therefor made as threads in main
         vector<Point> calculateRoadmapPoints(Mat roadmap);
         vector<Point> calculateTestPoints(Mat roadmap, vector<Point> roadmapPoints);
         vector<double> getResults();
-        void calculateDistThread(Mat roadmap, vector<Point> testPoints, vector<Point> roadmapPoints, int threadNumber, int amountOfThreads); // is not used because of threads in qt
+        void calculateDistThread(Mat roadmap, vector<Point> testPoints, vector<Point> roadmapPoints, int threadNumber, int amountOfThreads); // is not used because of threads in qt, see get_paths
         Mat showPath(Mat smallworld, Mat roadmap, vector<Point> roadmapPoints, Point startPoints, Point endPoints);
-        vector<double> findAstarPathLengthsForRoadmapRandom(Mat roadmap, vector<Point> roadmapPoints ,vector<Point> startPoints, vector<Point> endPoints);
+        vector<double> findAstarPathLengthsForRoadmapRandom(Mat roadmap, vector<Point> roadmapPoints ,vector<Point> startPoints, vector<Point> endPoints); // Graph searched per query, batches should hold a table
+        vector<double> findAstarPathLengthsForRoadmapRandom(Mat roadmap, vector<Point> roadmapPoints ,vector<Point> startPoints, vector<Point> endPoints, const Roadmap_Distance_Table &distanceTable); // Lengths looked up in a precomputed table
+        vector<double> findAstarPathLengthsForRoadmapRandom(Mat roadmap, vector<Point> startPoints, vector<Point> endPoints, const Roadmap_Distance_Table &distanceTable, const Roadmap_Snap_Field &snapField); // Snapped with a precomputed field
         vector<Point> checkInvalidTestPoints(Mat roadmap, vector<Point> roadmapPoints, vector<Point> checkpoints);
+        vector<Point> checkInvalidTestPoints(Mat roadmap, const Roadmap_Snap_Field &snapField, vector<Point> checkpoints);
         vector<Point> findNRemoveDiff(vector<Point> testPoint1, vector<Point> testPoint2);
-        Point findWayToRoadMap(Mat roadmap, vector<Point> roadmapPoints, Point entryExitPoint);
+        Point findWayToRoadMap(Mat roadmap, vector<Point> roadmapPoints, Point entryExitPoint); // Point(-1, -1) if no roadmap point is visible. Walks every line on the Mat, callers with many points hold a Line_Of_Sight
+        Point findWayToRoadMap(const Line_Of_Sight &sight, const vector<Point> &roadmapPoints, Point entryExitPoint); // Same with a prepared obstacle mask
+        Point findWayToRoadMap(const Roadmap_Snap_Field &snapField, Point entryExitPoint); // Same result, one lookup
         ~A_Star();
 
     private:
-        Mat map, map_a_star;
-        vector<Map_Node *> open_list;
-        Map_Node *start_node, *goal_node;
+        Mat map_a_star;
+        int open_list_policy = OPEN_LIST_BINARY_HEAP;
+        int expansion_mode = EXPANSION_NEIGHBORS;
+        std::unique_ptr<Open_List> open_list;
         Map_Size map_size;
-        vector<Map_Node> map_data;
+
+        /*************************************************************
+         *  Node state as flat arrays ( struct of arrays ), indexed by
+         *  id = ( y + 1 ) * stride + ( x + 1 ). The grid has a one cell
+         *  border of blocked cells, so neighbors and jumps never leave
+         *  the arrays and need no bounds checks. x and y are not stored,
+         *  they follow from the id.
+         *
+         *  4 + 4 bytes and 2 bits per cell, the old Map_Node was 40
+         *  bytes plus the 3 byte copy of the image.
+         ************************************************************/
+        int stride = 0;                 // map_size.width + 2
+        vector<int> g;                  // Cost from start, G_UNSEEN = not reached
+        vector<int> parent;             // Id of the parent, valid when g is set
+        Bit_Plane blocked;              // Obstacles and the border
+        Bit_Plane closed;               // Expanded nodes
+        int start_index = 0, goal_index = 0;
+        int offsets[8];                 // Id offset of L, T, R, B, LT, RT, RB, LB
+
+        // ALT heuristic, only used if start and goal are nodes of the table
+        const Landmark_Table *landmarks = nullptr;
+        bool use_landmarks = false;
+
+        // Anytime search
+        double anytime_epsilon = 3.0, anytime_step = 0.5;
+        Index_Heap anytime_open;        // Key = ( g + epsilon * h ) * 1000
+        Bit_Plane inconsistent;         // Improved after being closed in this iteration
+        vector<int> incons;             // The inconsistent nodes, opened again on the next epsilon
+        vector<int> touched;            // Every node with a g value
+
+        // Any-angle search
+        Index_Heap any_angle_open;      // Key = g + Euclidean distance to the goal
+        Line_Of_Sight any_angle_sight;  // Obstacles of the floor plan
+
         // Experiments results
         vector<double> results;
         void print_map( const cv::Mat &img,
                         const string &s);
 
+        /**
+         * @brief draw_path -> Path red on map_a_star, if there is one
+         * @param path
+         */
+        void draw_path( const std::vector<cv::Point> &path );
+
+        int index_of( const int x, const int y ) const { return ( y + 1 ) * stride + ( x + 1 ); }
+        cv::Point point_of( const int id ) const { return Point( id % stride - 1, id / stride - 1 ); }
+
         /**
          * @brief manhatten_distance
-         * @param node1
-         * @param node2
+         * @param id1
+         * @param id2
          * @return
          */
-        int manhatten_dist( const Map_Node *node1,
-                            const Map_Node *node2 );
+        int manhatten_dist( const int id1,
+                            const int id2 );
 
         /**
          * @brief diagonal_dist
-         * @param node1
-         * @param node2
+         * @param id1
+         * @param id2
          * @return
          */
-        int diagonal_dist( const Map_Node *node1,
-                           const Map_Node *node2 );
+        int diagonal_dist( const int id1,
+                           const int id2 );
         /**
          * @brief compute_h
-         * @param node1
-         * @param node2
+         * @param id1
+         * @param id2
          * @return
          */
-        int compute_h( const Map_Node *node1,
-                       const Map_Node *node2 );
+        int compute_h( const int id1,
+                       const int id2 );
         /**
          * @brief compute_g
-         * @param node1
-         * @param node2
+         * @param id1
+         * @param id2
          * @return
          */
-        int compute_g( const Map_Node *node1,
-                       const Map_Node *node2 );
+        int compute_g( const int id1,
+                       const int id2 );
+
         /**
-         * @brief map_at
-         * @param x
-         * @param y
+         * @brief euclidean_cost -> Straight line cost in G_DIRECT units,
+         *      the same as compute_g for neighbors
+         * @param id1
+         * @param id2
          * @return
          */
-        Map_Node *map_at( const int x, const int y );
+        int euclidean_cost( const int id1,
+                            const int id2 );
 
         /**
          * @brief neighbors
-         * @param node
-         * @return
+         * @param id
+         * @param out => Room for 8 ids, filled with the free neighbors
+         * @return Number of neighbors written to out
          */
-        std::vector<Map_Node *> neighbors( const Map_Node *node );
+        int neighbors( const int id, int *out );
 
         /**
-         * @brief find
+         * @brief walkable
+         * @param id
+         * @return true if not an obstacle or the border
+         */
+        bool walkable( const int id );
+
+        /**
+         * @brief jump -> Move from id in direction dx, dy until a jump point
+         * @param id
+         * @param dx
+         * @param dy
+         * @return The jump point or -1 if an obstacle or the border is hit
+         */
+        int jump( int id, const int dx, const int dy );
+
+        /**
+         * @brief jump_successors -> Jump points reached from the pruned
+         *      neighbors of id, replaces neighbors() in Jump Point Search
+         * @param id
+         * @param out => Room for 8 ids
+         * @return Number of jump points written to out
+         */
+        int jump_successors( const int id, int *out );
+
+        /**
+         * @brief improve_path -> One ARA* iteration, expand until the goal
+         *      has the lowest key
+         * @param epsilon_m => Epsilon * 1000
+         * @param deadline
+         * @param interruptible => false = ignore the deadline
+         * @return false if the deadline was hit
+         */
+        bool improve_path( const long long epsilon_m,
+                           const std::chrono::steady_clock::time_point &deadline,
+                           const bool interruptible );
+
+        /**
+         * @brief anytime_bound
+         * @param epsilon
+         * @return Suboptimality bound of the path to the goal, min( epsilon,
+         *      g( goal ) / lowest g + h of the open and inconsistent nodes )
+         */
+        double anytime_bound( const double epsilon );
+
+        /**
+         * @brief trace_path -> Path from start ( excluded ) to goal by parents
          * @return
          */
-        std::vector<Map_Node *> find();
+        std::vector<cv::Point> trace_path();
 
         /**
-         * @brief draw_open_list
+         * @brief load_map -> Fill the node arrays from the image
+         * @param img
+         * @param start
+         * @param goal
+         * @param floor_plan => false = red pixels are free ( roadmap ),
+         *      true = everything but black pixels is free
          */
-        void draw_open_list();
+        void load_map( const cv::Mat &img,
+                       const cv::Point &start,
+                       const cv::Point &goal,
+                       const bool floor_plan );
 
         /**
-         * @brief draw_path
+         * @brief search -> Load the map and run find
          * @param img
-         * @param path
+         * @param start
+         * @param goal
+         * @param floor_plan => See load_map
+         * @param observer
+         * @return
+         */
+        template<class Observer>
+        std::vector<cv::Point> search( const cv::Mat &img,
+                                       const cv::Point &start,
+                                       const cv::Point &goal,
+                                       const bool floor_plan,
+                                       Observer &observer );
+
+        /**
+         * @brief find
+         * @param observer => Gets every expanded and opened node
+         * @return Path from start ( excluded ) to goal, empty if not found
          */
-        void draw_path( const std::vector<Map_Node *> path );
+        template<class Observer>
+        std::vector<cv::Point> find( Observer &observer );
         
         // Experiment functions
-        vector<Point> get_points(LineIterator &it);
+        vector<double> findAstarPathLengthsForSnappedPoints(Mat roadmap, const Line_Of_Sight &sight, const vector<Point> &startPoints, const vector<Point> &endPoints, const Roadmap_Distance_Table &distanceTable, const std::function<Point(const Point &)> &snap);
         bool obstacleDetectedWithLine(Mat roadmap, Point start, Point end);
         double calculateDiagonalDist(Point p1, Point p2);
 
@@ -0,0 +1,50 @@
+#ifndef BIT_PLANE_H
+#define BIT_PLANE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+using namespace std;
+
+class Bit_Plane
+{
+    /*************************************************************
+     *  One bit per cell, packed in 64 bit words. Used for flags of
+     *  large grids where a byte or a bool per cell costs too much
+     *  memory and cache.
+     ************************************************************/
+    public:
+        Bit_Plane() {}
+        Bit_Plane( const size_t size, const bool value = false ) { assign( size, value ); }
+
+        /**
+         * @brief assign -> Resize to size bits, all set to value
+         * @param size
+         * @param value
+         */
+        void assign( const size_t size, const bool value = false )
+        {
+            bits = size;
+            words.assign( ( size + 63 ) / 64, value ? ~(uint64_t)0 : 0 );
+        }
+
+        bool test( const size_t i ) const { return ( words[ i >> 6 ] >> ( i & 63 ) ) & 1; }
+        void set( const size_t i ) { words[ i >> 6 ] |= (uint64_t)1 << ( i & 63 ); }
+        void reset( const size_t i ) { words[ i >> 6 ] &= ~( (uint64_t)1 << ( i & 63 ) ); }
+
+        /**
+         * @brief clear -> All bits to 0, keeps the size
+         */
+        void clear() { std::fill( words.begin(), words.end(), 0 ); }
+
+        size_t size() const { return bits; }
+        const uint64_t *data() const { return words.data(); }
+
+    private:
+        size_t bits = 0;
+        std::vector<uint64_t> words;
+};
+
+#endif // BIT_PLANE_H
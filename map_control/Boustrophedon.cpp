@@ -600,13 +600,7 @@ tuple<string, Point> Boustrophedon::getClosestPointRight(vector<Point> samex, ve
 
 bool Boustrophedon::obstacleDetectedWithLine(Point start, Point end)
 {
-    LineIterator it(this->map, start, end, 8); // 8 for diagonal
-    for (int i = 0; i < it.count; i++, it++) // next point on line
-    {
-        if ( (int)this->map.at<uchar>( it.pos() ) == 0 )
-            return true;
-    }
-    return false;
+    return Line_Of_Sight::obstacle_on_line(this->map, start, end, Scalar(0));
 }
 
 bool Boustrophedon::findNremovePoint(vector<Point> &list, Point point)
@@ -14,6 +14,7 @@
 
 #include <Cell.h>
 #include <Cellpoint.h>
+#include "Line_Of_Sight.h"
 
 using namespace std;
 using namespace cv;
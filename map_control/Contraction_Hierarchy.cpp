@@ -0,0 +1,514 @@
+#include "Contraction_Hierarchy.h"
+#include "Grid_Map.h"
+
+#include <climits>
+
+// Vertices a witness search may settle before it gives up and the shortcut is added anyway
+static const int WITNESS_SETTLE_LIMIT = 500;
+
+// -----------------------------------------------------------------------
+
+Contraction_Hierarchy::Contraction_Hierarchy() {}
+
+// -----------------------------------------------------------------------
+
+Contraction_Hierarchy::Contraction_Hierarchy( const Roadmap_Graph &graph ) { build( graph ); }
+
+// -----------------------------------------------------------------------
+
+Contraction_Hierarchy::~Contraction_Hierarchy() {}
+
+// -----------------------------------------------------------------------
+
+void Contraction_Hierarchy::build( const Roadmap_Graph &graph )
+{
+    this->graph = &graph;
+    n = (int)graph.get_vertices().size();
+    fingerprint = graph.make_fingerprint();
+
+    // Every graph edge is an arc, loops never lie on a shortest path between vertices
+    const std::vector<Graph_Edge> &edges = graph.get_edges();
+    std::vector<std::vector<int>> adjacency( n );
+    arcs.clear();
+    for (size_t id = 0; id < edges.size(); id++)
+    {
+        const Graph_Edge &e = edges[id];
+        if ( e.from == e.to )
+            continue;
+
+        Hierarchy_Arc arc;
+        arc.from = e.from;
+        arc.to = e.to;
+        arc.cost = e.cost();
+        arc.edge = (int)id;
+        adjacency[e.from].push_back( (int)arcs.size() );
+        adjacency[e.to].push_back( (int)arcs.size() );
+        arcs.push_back( arc );
+    }
+
+    std::vector<uchar> contracted( n, 0 );
+    std::vector<int> deleted_neighbors( n, 0 );
+    Search_Workspace workspace;
+    workspace.resize( n );
+
+    // Edge difference + contracted neighbors, lower = contract earlier
+    auto priority = [&]( const int v )
+    {
+        int shortcuts = contract( v, adjacency, contracted, workspace, false );
+        int degree = 0;
+        for ( auto& a : adjacency[v] )
+            if ( !contracted[ other_end( a, v ) ] )
+                degree++;
+        return (long long)( shortcuts - degree + deleted_neighbors[v] );
+    };
+
+    Index_Heap queue;
+    queue.reserve( n );
+    for (int v = 0; v < n; v++)
+        queue.push( v, priority( v ) );
+
+    // Lazy updates, a vertex whose priority went up since it was pushed goes back in
+    rank.assign( n, 0 );
+    int order = 0;
+    while ( !queue.empty() )
+    {
+        int v = queue.pop();
+        long long p = priority( v );
+        if ( !queue.empty() && p > queue.top_key() )
+        {
+            queue.push( v, p );
+            continue;
+        }
+
+        contract( v, adjacency, contracted, workspace, true );
+        contracted[v] = 1;
+        rank[v] = order++;
+
+        for ( auto& a : adjacency[v] )
+        {
+            int u = other_end( a, v );
+            if ( contracted[u] )
+                continue;
+            deleted_neighbors[u]++;
+            queue.push( u, priority( u ) );
+        }
+    }
+
+    build_upward();
+}
+
+// -----------------------------------------------------------------------
+
+int Contraction_Hierarchy::contract( const int v,
+                                     std::vector<std::vector<int>> &adjacency,
+                                     const std::vector<uchar> &contracted,
+                                     Search_Workspace &workspace,
+                                     const bool add )
+{
+    // The cheapest arc to every remaining neighbor
+    std::vector<int> neighbor, cost, arc;
+    for ( auto& a : adjacency[v] )
+    {
+        int u = other_end( a, v );
+        if ( contracted[u] || u == v )
+            continue;
+
+        size_t i = std::find( neighbor.begin(), neighbor.end(), u ) - neighbor.begin();
+        if ( i == neighbor.size() )
+        {
+            neighbor.push_back( u );
+            cost.push_back( arcs[a].cost );
+            arc.push_back( a );
+        }
+        else if ( arcs[a].cost < cost[i] )
+        {
+            cost[i] = arcs[a].cost;
+            arc[i] = a;
+        }
+    }
+    if ( neighbor.size() < 2 )
+        return 0;
+
+    int max_cost = *std::max_element( cost.begin(), cost.end() );
+    int shortcuts = 0;
+    for (size_t i = 0; i + 1 < neighbor.size(); i++)
+    {
+        witness( neighbor[i], v, cost[i] + max_cost, adjacency, contracted, workspace );
+        for (size_t j = i + 1; j < neighbor.size(); j++)
+        {
+            int via = cost[i] + cost[j];
+            int w = neighbor[j];
+            if ( workspace.seen[w] == workspace.generation && workspace.g[w] <= via )
+                continue; // As short without v
+
+            shortcuts++;
+            if ( !add )
+                continue;
+
+            Hierarchy_Arc shortcut;
+            shortcut.from = neighbor[i];
+            shortcut.to = w;
+            shortcut.cost = via;
+            shortcut.first = arc[i];
+            shortcut.second = arc[j];
+            shortcut.middle = v;
+            adjacency[ neighbor[i] ].push_back( (int)arcs.size() );
+            adjacency[w].push_back( (int)arcs.size() );
+            arcs.push_back( shortcut );
+        }
+    }
+    return shortcuts;
+}
+
+// -----------------------------------------------------------------------
+
+void Contraction_Hierarchy::witness( const int source, const int via, const int limit,
+                                     const std::vector<std::vector<int>> &adjacency,
+                                     const std::vector<uchar> &contracted,
+                                     Search_Workspace &workspace ) const
+{
+    workspace.next_generation();
+    const unsigned int generation = workspace.generation;
+    Index_Heap &open_list = workspace.open_list;
+    open_list.clear();
+
+    workspace.seen[source] = generation;
+    workspace.g[source] = 0;
+    open_list.push( source, 0 );
+
+    int settled = 0;
+    while ( !open_list.empty() && open_list.top_key() <= limit && settled < WITNESS_SETTLE_LIMIT )
+    {
+        int u = open_list.pop();
+        settled++;
+        for ( auto& a : adjacency[u] )
+        {
+            int w = other_end( a, u );
+            if ( w == via || contracted[w] )
+                continue;
+
+            int new_g = workspace.g[u] + arcs[a].cost;
+            if ( workspace.seen[w] != generation || new_g < workspace.g[w] )
+            {
+                workspace.seen[w] = generation;
+                workspace.g[w] = new_g;
+                open_list.push( w, new_g );
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+
+void Contraction_Hierarchy::build_upward()
+{
+    // Every arc is stored once, at its lower ranked end
+    up_first.assign( n + 1, 0 );
+    for ( auto& a : arcs )
+        up_first[ ( rank[a.from] < rank[a.to] ) ? a.from : a.to ]++;
+    for (int v = 0, sum = 0; v <= n; v++)
+    {
+        int count = up_first[v];
+        up_first[v] = sum;
+        sum += count;
+    }
+
+    up_arcs.assign( arcs.size(), 0 );
+    std::vector<int> fill( up_first.begin(), up_first.end() - 1 );
+    for (size_t id = 0; id < arcs.size(); id++)
+    {
+        const Hierarchy_Arc &a = arcs[id];
+        up_arcs[ fill[ ( rank[a.from] < rank[a.to] ) ? a.from : a.to ]++ ] = (int)id;
+    }
+}
+
+// -----------------------------------------------------------------------
+
+int Contraction_Hierarchy::other_end( const int arc, const int v ) const
+{
+    return ( arcs[arc].from == v ) ? arcs[arc].to : arcs[arc].from;
+}
+
+// -----------------------------------------------------------------------
+
+bool Contraction_Hierarchy::find_path( const cv::Point &start,
+                                       const cv::Point &goal,
+                                       std::vector<cv::Point> &path )
+{
+    return find_path( start, goal, path, default_forward, default_backward );
+}
+
+// -----------------------------------------------------------------------
+
+bool Contraction_Hierarchy::find_path( const cv::Point &start,
+                                       const cv::Point &goal,
+                                       std::vector<cv::Point> &path,
+                                       Search_Workspace &forward,
+                                       Search_Workspace &backward ) const
+{
+    path.clear();
+
+    Point s, t;
+    if ( !graph || !graph->anchors( start, goal, s, t ) ||
+         ( s != t && !find_kept_path( s, t, path, forward, backward ) ) )
+        return false;
+
+    graph->attach_ends( start, goal, path );
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+bool Contraction_Hierarchy::find_kept_path( const cv::Point &start,
+                                            const cv::Point &goal,
+                                            std::vector<cv::Point> &path,
+                                            Search_Workspace &forward,
+                                            Search_Workspace &backward ) const
+{
+    int sv, se, si, gv, ge, gi;
+    if ( !graph || start == goal ||
+         !graph->locate( start, sv, se, si ) ||
+         !graph->locate( goal, gv, ge, gi ) )
+        return false;
+
+    const std::vector<Graph_Edge> &edges = graph->get_edges();
+    Search_Workspace *sides[2] = { &forward, &backward };
+    for ( auto& s : sides )
+    {
+        s->resize( n );
+        s->next_generation();
+        s->open_list.clear();
+    }
+
+    // Seed with the vertex, or both ends of the edge the pixel is on
+    auto seed = [&]( Search_Workspace &s, const int v, const int cost )
+    {
+        if ( s.seen[v] == s.generation && s.g[v] <= cost )
+            return;
+        s.seen[v] = s.generation;
+        s.g[v] = cost;
+        s.parent[v] = -1;
+        s.open_list.push( v, cost );
+    };
+
+    if ( sv >= 0 )
+        seed( forward, sv, 0 );
+    else
+    {
+        seed( forward, edges[se].from, graph->chain_cost( edges[se], si ) );
+        seed( forward, edges[se].to, edges[se].cost() - graph->chain_cost( edges[se], si ) );
+    }
+    if ( gv >= 0 )
+        seed( backward, gv, 0 );
+    else
+    {
+        seed( backward, edges[ge].from, graph->chain_cost( edges[ge], gi ) );
+        seed( backward, edges[ge].to, edges[ge].cost() - graph->chain_cost( edges[ge], gi ) );
+    }
+
+    long long best = INT_MAX;
+    int meet = -1;
+    if ( sv < 0 && gv < 0 && se == ge ) // Straight along the shared edge
+    {
+        best = abs( graph->chain_cost( edges[se], si ) - graph->chain_cost( edges[se], gi ) );
+        meet = -2;
+    }
+
+    // Both sides only go up in rank, always advance the one with the lower key
+    while ( true )
+    {
+        long long kf = forward.open_list.empty() ? LLONG_MAX : forward.open_list.top_key();
+        long long kb = backward.open_list.empty() ? LLONG_MAX : backward.open_list.top_key();
+        if ( min( kf, kb ) >= best ) // Nothing left can beat best
+            break;
+
+        Search_Workspace &s = ( kf <= kb ) ? forward : backward;
+        Search_Workspace &o = ( kf <= kb ) ? backward : forward;
+        int u = s.open_list.pop();
+        s.closed[u] = s.generation;
+
+        if ( o.seen[u] == o.generation && (long long)s.g[u] + o.g[u] < best )
+        {
+            best = (long long)s.g[u] + o.g[u];
+            meet = u;
+        }
+
+        for (int i = up_first[u]; i < up_first[u + 1]; i++)
+        {
+            int a = up_arcs[i];
+            int w = other_end( a, u );
+            int new_g = s.g[u] + arcs[a].cost;
+            if ( s.seen[w] != s.generation || new_g < s.g[w] )
+            {
+                s.seen[w] = s.generation;
+                s.g[w] = new_g;
+                s.parent[w] = a;
+                s.open_list.push( w, new_g );
+            }
+        }
+    }
+
+    if ( meet == -1 ) // Havent found goal
+        return false;
+
+    if ( meet == -2 )
+    {
+        graph->append_chain( edges[se], si, gi, path );
+        return true;
+    }
+
+    // Arcs from the start side up to the meeting vertex, then down to the goal side
+    std::vector<int> &route = forward.route;
+    route.clear();
+    int first = meet;
+    while ( forward.parent[first] >= 0 )
+    {
+        route.push_back( forward.parent[first] );
+        first = other_end( forward.parent[first], first );
+    }
+    reverse( route.begin(), route.end() );
+
+    std::vector<std::pair<int, int>> steps;
+    int v = first;
+    for ( auto& a : route )
+    {
+        unpack( a, v, steps );
+        v = other_end( a, v );
+    }
+    while ( backward.parent[v] >= 0 )
+    {
+        int a = backward.parent[v];
+        unpack( a, v, steps );
+        v = other_end( a, v );
+    }
+    int last = v;
+
+    if ( sv < 0 ) // From the start pixel to the first vertex
+    {
+        const Graph_Edge &e = edges[se];
+        int end = (int)e.pixels.size() - 1;
+        bool from_side = ( first == e.from );
+        if ( e.from == e.to )
+            from_side = ( graph->chain_cost( e, si ) <= e.cost() - graph->chain_cost( e, si ) );
+        graph->append_chain( e, si, from_side ? -1 : end, path );
+    }
+
+    for ( auto& step : steps )
+    {
+        const Graph_Edge &e = edges[step.first];
+        int end = (int)e.pixels.size() - 1;
+        if ( e.from == step.second )
+            graph->append_chain( e, -1, end, path );
+        else
+            graph->append_chain( e, end, -1, path );
+    }
+
+    if ( gv < 0 ) // From the last vertex to the goal pixel
+    {
+        const Graph_Edge &e = edges[ge];
+        int end = (int)e.pixels.size() - 1;
+        bool from_side = ( last == e.from );
+        if ( e.from == e.to )
+            from_side = ( graph->chain_cost( e, gi ) <= e.cost() - graph->chain_cost( e, gi ) );
+        graph->append_chain( e, from_side ? -1 : end, gi, path );
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+void Contraction_Hierarchy::unpack( const int arc, const int from,
+                                    std::vector<std::pair<int, int>> &steps ) const
+{
+    const Hierarchy_Arc &a = arcs[arc];
+    if ( a.edge >= 0 )
+    {
+        steps.push_back( std::make_pair( a.edge, from ) );
+        return;
+    }
+
+    // first joins "from" and middle, second joins middle and "to"
+    if ( from == a.from )
+    {
+        unpack( a.first, from, steps );
+        unpack( a.second, a.middle, steps );
+    }
+    else
+    {
+        unpack( a.second, from, steps );
+        unpack( a.first, a.middle, steps );
+    }
+}
+
+// -----------------------------------------------------------------------
+
+bool Contraction_Hierarchy::save( const std::string &file ) const
+{
+    ofstream out( file, ios::binary );
+    if ( !out )
+        return false;
+
+    write_header( out, "RCH2", fingerprint );
+    write_binary( out, n );
+    write_binary( out, (int)arcs.size() );
+    write_binary( out, rank );
+    write_binary( out, arcs );
+    return (bool)out;
+}
+
+// -----------------------------------------------------------------------
+
+bool Contraction_Hierarchy::load( const std::string &file, const Roadmap_Graph &graph )
+{
+    unsigned long long graph_fingerprint = graph.make_fingerprint();
+    ifstream in( file, ios::binary );
+    if ( !in || !read_header( in, "RCH2", graph_fingerprint ) )
+        return false; // Made from another roadmap
+
+    int file_n = 0, arc_count = 0;
+    read_binary( in, file_n );
+    read_binary( in, arc_count );
+    if ( !in || file_n != (int)graph.get_vertices().size() || arc_count < 0 )
+        return false;
+
+    std::vector<int> file_rank( file_n );
+    std::vector<Hierarchy_Arc> file_arcs( arc_count );
+    read_binary( in, file_rank );
+    read_binary( in, file_arcs );
+    if ( !in )
+        return false;
+
+    this->graph = &graph;
+    n = file_n;
+    fingerprint = graph_fingerprint;
+    rank.swap( file_rank );
+    arcs.swap( file_arcs );
+    build_upward();
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+const std::vector<Hierarchy_Arc> &Contraction_Hierarchy::get_arcs() const { return arcs; }
+
+// -----------------------------------------------------------------------
+
+int Contraction_Hierarchy::get_rank( const int vertex ) const { return rank[vertex]; }
+
+// -----------------------------------------------------------------------
+
+int Contraction_Hierarchy::get_shortcut_count() const
+{
+    int count = 0;
+    for ( auto& a : arcs )
+        if ( a.edge < 0 )
+            count++;
+    return count;
+}
+
+// -----------------------------------------------------------------------
+
+int Contraction_Hierarchy::get_vertex_count() const { return n; }
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,174 @@
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Open_List.h"
+#include "Roadmap_Graph.h"
+#include "Search_Workspace.h"
+
+using namespace std;
+using namespace cv;
+
+struct Hierarchy_Arc
+{
+    int from = -1, to = -1;
+    int cost = 0;           // G_DIRECT/G_SKEW units
+    int edge = -1;          // Roadmap_Graph edge, -1 = shortcut
+    int first = -1;         // Shortcut => arc from "from" to middle
+    int second = -1;        // Shortcut => arc from middle to "to"
+    int middle = -1;        // Shortcut => the contracted vertex it bridges
+};
+
+class Contraction_Hierarchy
+{
+    /*************************************************************
+     *  Contraction hierarchy ( Geisberger et al. 2008 ) over the
+     *  vertices of a Roadmap_Graph.
+     *
+     *  The vertices are contracted one by one, least important
+     *  first ( edge difference plus contracted neighbors ). When a
+     *  vertex is removed, a shortcut is added between two of its
+     *  neighbors unless a local witness search finds a path that
+     *  is at least as short without it. Every vertex gets its rank
+     *  in this order.
+     *
+     *  A query runs Dijkstra from the start and from the goal, both
+     *  only along arcs to higher ranks, and the two meet at the
+     *  highest vertex of the shortest path. Each side settles a few
+     *  dozen vertices. Shortcuts remember the two arcs they replace,
+     *  so the path is unpacked to graph edges and then to pixels in
+     *  the same format as A_Star::get_path.
+     *
+     *  The hierarchy does not change after build, the const
+     *  find_path is thread-safe with a pair of workspaces per thread.
+     *  It can be saved next to the roadmap, a fingerprint of the
+     *  graph makes sure it belongs to it.
+     ************************************************************/
+    public:
+        Contraction_Hierarchy();
+
+        /**
+         * @brief Contraction_Hierarchy
+         * @param graph => Must outlive the hierarchy
+         */
+        Contraction_Hierarchy( const Roadmap_Graph &graph );
+
+        /**
+         * @brief build -> Contract all vertices of the graph
+         * @param graph => Must outlive the hierarchy
+         */
+        void build( const Roadmap_Graph &graph );
+
+        /**
+         * @brief save -> Write the hierarchy to a binary file
+         * @param file => e.g. "voronoi_roadmap.png.ch"
+         * @return
+         */
+        bool save( const std::string &file ) const;
+
+        /**
+         * @brief load -> Read a hierarchy written by save()
+         * @param file
+         * @param graph => The graph the hierarchy was built from
+         * @return false if the file is missing or belongs to another graph
+         */
+        bool load( const std::string &file, const Roadmap_Graph &graph );
+
+        /**
+         * @brief find_path -> Shortest path between two roadmap pixels
+         * @param start => Must be a roadmap pixel
+         * @param goal => Must be a roadmap pixel
+         * @param path => Cleared and filled with the pixel path, start
+         *      excluded and goal included ( same as A_Star::get_path )
+         * @param forward => Workspace of the search from the start
+         * @param backward => Workspace of the search from the goal
+         * @return true if a path was found
+         */
+        bool find_path( const cv::Point &start,
+                        const cv::Point &goal,
+                        std::vector<cv::Point> &path,
+                        Search_Workspace &forward,
+                        Search_Workspace &backward ) const;
+
+        /**
+         * @brief find_path -> As above with the workspaces of this object,
+         *      not thread-safe
+         */
+        bool find_path( const cv::Point &start,
+                        const cv::Point &goal,
+                        std::vector<cv::Point> &path );
+
+        const std::vector<Hierarchy_Arc> &get_arcs() const;
+        int get_rank( const int vertex ) const;
+        int get_shortcut_count() const;
+        int get_vertex_count() const;
+
+        ~Contraction_Hierarchy();
+
+    private:
+        const Roadmap_Graph *graph = 0;
+        int n = 0;
+        unsigned long long fingerprint = 0;
+        std::vector<int> rank;              // Contraction order of every vertex
+        std::vector<Hierarchy_Arc> arcs;    // Graph edges first, then the shortcuts
+        std::vector<int> up_first;          // n + 1, arcs of v to higher ranks are
+        std::vector<int> up_arcs;           //  up_arcs[ up_first[v] .. up_first[v+1] )
+
+        Search_Workspace default_forward, default_backward; // Used by the single threaded find_path
+
+        /**
+         * @brief contract -> Shortcuts needed to remove v
+         * @param v
+         * @param adjacency => Arcs of every vertex that is not contracted yet
+         * @param contracted
+         * @param workspace => For the witness searches
+         * @param add => false = only count them
+         * @return Number of shortcuts
+         */
+        int contract( const int v,
+                      std::vector<std::vector<int>> &adjacency,
+                      const std::vector<uchar> &contracted,
+                      Search_Workspace &workspace,
+                      const bool add );
+
+        /**
+         * @brief witness -> Dijkstra from source without passing via,
+         *      stops at limit or after a few hundred vertices. The
+         *      distances found are left in g of the workspace.
+         */
+        void witness( const int source, const int via, const int limit,
+                      const std::vector<std::vector<int>> &adjacency,
+                      const std::vector<uchar> &contracted,
+                      Search_Workspace &workspace ) const;
+
+        void build_upward();
+
+        /**
+         * @brief find_kept_path -> find_path between two kept roadmap pixels
+         */
+        bool find_kept_path( const cv::Point &start,
+                             const cv::Point &goal,
+                             std::vector<cv::Point> &path,
+                             Search_Workspace &forward,
+                             Search_Workspace &backward ) const;
+
+        /**
+         * @brief unpack -> Graph edges of an arc in walking order
+         * @param arc
+         * @param from => The end of the arc the walk starts at
+         * @param steps => ( graph edge, vertex it is entered from ) is appended
+         */
+        void unpack( const int arc, const int from,
+                     std::vector<std::pair<int, int>> &steps ) const;
+
+        int other_end( const int arc, const int v ) const;
+};
+
+#endif // CONTRACTION_HIERARCHY_H
@@ -0,0 +1,263 @@
+#include "D_Star_Lite.h"
+#include "Grid_Map.h"
+
+// Unreachable, small enough that INF + h + km still fits the 32 bit half of a key
+static const int INF = 0x3fffffff;
+
+// -----------------------------------------------------------------------
+
+D_Star_Lite::D_Star_Lite() {}
+
+// -----------------------------------------------------------------------
+
+D_Star_Lite::D_Star_Lite( const cv::Mat &map, const bool floor_plan ) { set_map( map, floor_plan ); }
+
+// -----------------------------------------------------------------------
+
+D_Star_Lite::~D_Star_Lite() {}
+
+// -----------------------------------------------------------------------
+
+void D_Star_Lite::set_map( const cv::Mat &map, const bool floor_plan )
+{
+    width = map.cols;
+    height = map.rows;
+    size_t size = (size_t)width * height;
+
+    load_blocked( map, floor_plan, blocked );
+
+    g.assign( size, INF );
+    rhs.assign( size, INF );
+    open_list.reserve( size );
+    start = goal = last = -1;
+}
+
+// -----------------------------------------------------------------------
+
+int D_Star_Lite::compute_h( const int id1, const int id2 ) const
+{
+    int dx = abs( id1 % width - id2 % width );
+    int dy = abs( id1 / width - id2 / width );
+
+    if ( dx > dy ) // Octile, never overestimates
+        return G_SKEW * dy + G_DIRECT * ( dx - dy );
+    else
+        return G_SKEW * dx + G_DIRECT * ( dy - dx );
+}
+
+// -----------------------------------------------------------------------
+
+int D_Star_Lite::cost( const int id1, const int id2 ) const
+{
+    if ( blocked[id1] || blocked[id2] )
+        return INF;
+    return compute_h( id1, id2 ); // Adjacent cells => G_DIRECT or G_SKEW
+}
+
+// -----------------------------------------------------------------------
+
+int D_Star_Lite::neighbors( const int id, int *out ) const
+{
+    int amount = 0, x = id % width, y = id / width;
+    for (int k = 0; k < 8; k++)
+    {
+        int nx = x + NEIGHBOR_DX[k], ny = y + NEIGHBOR_DY[k];
+        if ( nx >= 0 && ny >= 0 && nx < width && ny < height )
+            out[amount++] = ny * width + nx;
+    }
+    return amount;
+}
+
+// -----------------------------------------------------------------------
+
+long long D_Star_Lite::calculate_key( const int id ) const
+{
+    long long m = min( g[id], rhs[id] );
+    long long k1 = min( m + compute_h( start, id ) + km, (long long)INF );
+    return ( k1 << 32 ) | m;
+}
+
+// -----------------------------------------------------------------------
+
+void D_Star_Lite::update_rhs( const int id )
+{
+    if ( id == goal )
+        return;
+
+    int n[8], best = INF;
+    int amount = neighbors( id, n );
+    for (int k = 0; k < amount; k++)
+    {
+        int c = cost( id, n[k] );
+        if ( c < INF && g[ n[k] ] < INF )
+            best = min( best, c + g[ n[k] ] );
+    }
+    rhs[id] = best;
+}
+
+// -----------------------------------------------------------------------
+
+void D_Star_Lite::update_vertex( const int id )
+{
+    if ( g[id] != rhs[id] )
+        open_list.push( id, calculate_key( id ) ); // Insert or update
+    else
+        open_list.remove( id );
+}
+
+// -----------------------------------------------------------------------
+
+void D_Star_Lite::initialize( const cv::Point &start, const cv::Point &goal )
+{
+    this->start = last = start.y * width + start.x;
+    this->goal = goal.y * width + goal.x;
+    km = 0;
+
+    std::fill( g.begin(), g.end(), INF );
+    std::fill( rhs.begin(), rhs.end(), INF );
+    open_list.clear();
+
+    rhs[ this->goal ] = 0;
+    open_list.push( this->goal, calculate_key( this->goal ) );
+}
+
+// -----------------------------------------------------------------------
+
+void D_Star_Lite::move_start( const cv::Point &start )
+{
+    this->start = start.y * width + start.x;
+    km += compute_h( last, this->start ); // Old keys are now too low by at most this
+    last = this->start;
+}
+
+// -----------------------------------------------------------------------
+
+void D_Star_Lite::set_blocked( const cv::Point &p, const bool blocked )
+{
+    int id = p.y * width + p.x;
+    if ( this->blocked[id] == (uchar)blocked )
+        return;
+    this->blocked[id] = blocked;
+
+    if ( goal < 0 ) // Not initialized, nothing to repair
+        return;
+
+    // Every edge touching the cell changed cost
+    update_rhs( id );
+    update_vertex( id );
+
+    int n[8];
+    int amount = neighbors( id, n );
+    for (int k = 0; k < amount; k++)
+    {
+        update_rhs( n[k] );
+        update_vertex( n[k] );
+    }
+}
+
+// -----------------------------------------------------------------------
+
+bool D_Star_Lite::is_blocked( const cv::Point &p ) const
+{
+    return blocked[ p.y * width + p.x ] != 0;
+}
+
+// -----------------------------------------------------------------------
+
+void D_Star_Lite::compute_shortest_path()
+{
+    int n[8];
+    expansions = 0;
+    while ( !open_list.empty() &&
+            ( open_list.top_key() < calculate_key( start ) || rhs[start] != g[start] ) )
+    {
+        int u = open_list.top();
+        long long k_old = open_list.top_key();
+        long long k_new = calculate_key( u );
+        expansions++;
+
+        if ( k_old < k_new ) // Key is outdated because the robot moved
+        {
+            open_list.push( u, k_new );
+        }
+        else if ( g[u] > rhs[u] ) // Overconsistent => settle
+        {
+            g[u] = rhs[u];
+            open_list.remove( u );
+
+            int amount = neighbors( u, n );
+            for (int k = 0; k < amount; k++)
+            {
+                int c = cost( n[k], u );
+                if ( n[k] != goal && c < INF && c + g[u] < rhs[ n[k] ] )
+                {
+                    rhs[ n[k] ] = c + g[u];
+                    update_vertex( n[k] );
+                }
+            }
+        }
+        else // Underconsistent => raise and let the neighbors find another way
+        {
+            int g_old = g[u];
+            g[u] = INF;
+
+            int amount = neighbors( u, n );
+            for (int k = 0; k < amount; k++)
+            {
+                int c = cost( n[k], u );
+                if ( c < INF && rhs[ n[k] ] == c + g_old )
+                    update_rhs( n[k] );
+                update_vertex( n[k] );
+            }
+            if ( rhs[u] == g_old )
+                update_rhs( u );
+            update_vertex( u );
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+
+bool D_Star_Lite::replan( std::vector<cv::Point> &path )
+{
+    path.clear();
+    if ( start < 0 || goal < 0 || start == goal )
+        return false;
+
+    compute_shortest_path();
+    if ( g[start] >= INF ) // Havent found goal
+        return false;
+
+    // Follow the cheapest neighbor, g is exact along the way
+    int n[8];
+    for (int id = start; id != goal; )
+    {
+        int next = -1, best = INF;
+        int amount = neighbors( id, n );
+        for (int k = 0; k < amount; k++)
+        {
+            int c = cost( id, n[k] );
+            if ( c < INF && g[ n[k] ] < INF && c + g[ n[k] ] < best )
+            {
+                best = c + g[ n[k] ];
+                next = n[k];
+            }
+        }
+
+        if ( next < 0 || path.size() > blocked.size() )
+        {
+            path.clear();
+            return false;
+        }
+        path.push_back( Point( next % width, next / width ) );
+        id = next;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+int D_Star_Lite::get_expansions() const { return expansions; }
+
+// -----------------------------------------------------------------------
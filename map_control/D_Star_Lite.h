@@ -0,0 +1,108 @@
+#ifndef D_STAR_LITE_H
+#define D_STAR_LITE_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+#include "opencv2/imgcodecs.hpp"
+#include "opencv2/highgui.hpp"
+#include "opencv2/imgproc.hpp"
+
+#include <iostream>
+#include <vector>
+
+#include "Open_List.h"
+
+using namespace std;
+using namespace cv;
+
+class D_Star_Lite
+{
+    /*************************************************************
+     *  Incremental planner (D* Lite, Koenig & Likhachev 2002) on an
+     *  8-connected grid with the same step costs as A_Star.
+     *
+     *  The search runs from the goal towards the robot and keeps
+     *  g and rhs of every cell between calls. When cells become
+     *  blocked or free ( lidar detections, removed marbles ) only
+     *  the cells whose distance to the goal changes are expanded
+     *  again on the next replan, instead of the whole map.
+     *
+     *  Usage: initialize( start, goal ), replan( path ), then for
+     *  every step move_start() and set_blocked() followed by replan().
+     ************************************************************/
+    public:
+        D_Star_Lite();
+
+        /**
+         * @brief D_Star_Lite
+         * @param map => BGR image
+         * @param floor_plan => true = black pixels are blocked,
+         *      false = everything but red roadmap pixels is blocked
+         */
+        D_Star_Lite( const cv::Mat &map, const bool floor_plan = true );
+
+        /**
+         * @brief set_map -> Load which cells are blocked, resets the search
+         * @param map
+         * @param floor_plan
+         */
+        void set_map( const cv::Mat &map, const bool floor_plan = true );
+
+        /**
+         * @brief initialize -> Start a new search, forgets all g and rhs
+         * @param start => Must be a free cell
+         * @param goal => Must be a free cell
+         */
+        void initialize( const cv::Point &start, const cv::Point &goal );
+
+        /**
+         * @brief move_start -> The robot moved, the goal stays the same
+         * @param start
+         */
+        void move_start( const cv::Point &start );
+
+        /**
+         * @brief set_blocked -> Change the state of a cell, the search is
+         *      repaired on the next replan
+         * @param p
+         * @param blocked
+         */
+        void set_blocked( const cv::Point &p, const bool blocked );
+
+        bool is_blocked( const cv::Point &p ) const;
+
+        /**
+         * @brief replan -> Repair the search and extract the path
+         * @param path => Cleared and filled with the path, start excluded
+         *      and goal included ( same as A_Star::get_path ). Left empty
+         *      if the goal is unreachable.
+         * @return true if a path was found
+         */
+        bool replan( std::vector<cv::Point> &path );
+
+        /**
+         * @brief get_expansions
+         * @return Cells expanded by the last replan
+         */
+        int get_expansions() const;
+
+        ~D_Star_Lite();
+
+    private:
+        int width = 0, height = 0;
+        int start = -1, goal = -1, last = -1;
+        int km = 0, expansions = 0;
+        std::vector<uchar> blocked;
+        std::vector<int> g, rhs;
+        Index_Heap open_list;   // Key = ( k1 << 32 ) | k2
+
+        long long calculate_key( const int id ) const;
+        void update_vertex( const int id );
+        void update_rhs( const int id );
+        void compute_shortest_path();
+        int cost( const int id1, const int id2 ) const;
+        int compute_h( const int id1, const int id2 ) const;
+        int neighbors( const int id, int *out ) const;
+};
+
+#endif // D_STAR_LITE_H
@@ -0,0 +1,253 @@
+#include "Generalized_Voronoi.h"
+#include "Voronoi_Diagram.h"
+#include "Thread_Pool.h"
+
+#include <cmath>
+#include <climits>
+#include <limits>
+
+// Squared distance of pixels without an obstacle in their column or the whole plan
+static const long long FAR_AWAY = LLONG_MAX / 4;
+
+// 4-neighbors, the ridge is looked for between them
+static const int DX[4] = { -1, 0, 1, 0 };
+static const int DY[4] = {  0, -1, 0, 1 };
+
+// -----------------------------------------------------------------------
+
+/*
+ *  1D squared distance transform, d[q] = min over i of ( q - i )^2 + f[i]
+ *  and site[q] = the i that wins, -1 if every f[i] is FAR_AWAY.
+ *  v and z are scratch of n and n + 1 entries.
+ */
+static void lower_envelope( const long long *f, const int n, long long *d, int *site, int *v, double *z )
+{
+    int k = -1;
+    for (int q = 0; q < n; q++)
+    {
+        if ( f[q] >= FAR_AWAY )
+            continue;
+
+        // Parabolas that the new one hides are dropped from the envelope
+        double s = 0;
+        while ( k >= 0 )
+        {
+            s = ( ( f[q] + (long long)q * q ) - ( f[ v[k] ] + (long long)v[k] * v[k] ) ) / ( 2.0 * ( q - v[k] ) );
+            if ( s > z[k] )
+                break;
+            k--;
+        }
+        k++;
+        v[k] = q;
+        z[k] = ( k == 0 ) ? -HUGE_VAL : s;
+        z[k+1] = HUGE_VAL;
+    }
+
+    if ( k < 0 )
+    {
+        std::fill( d, d + n, FAR_AWAY );
+        std::fill( site, site + n, -1 );
+        return;
+    }
+
+    // Intersections are rationals with a small denominator, never rounded across an integer q
+    for (int q = 0, j = 0; q < n; q++)
+    {
+        while ( z[j+1] < q )
+            j++;
+        d[q] = (long long)( q - v[j] ) * ( q - v[j] ) + f[ v[j] ];
+        site[q] = v[j];
+    }
+}
+
+// -----------------------------------------------------------------------
+
+Generalized_Voronoi::Generalized_Voronoi() {}
+
+// -----------------------------------------------------------------------
+
+Generalized_Voronoi::Generalized_Voronoi( const cv::Mat &floor_plan,
+                                          const double min_separation,
+                                          const int threads )
+{
+    build( floor_plan, min_separation, threads );
+}
+
+// -----------------------------------------------------------------------
+
+Generalized_Voronoi::~Generalized_Voronoi() {}
+
+// -----------------------------------------------------------------------
+
+void Generalized_Voronoi::build( const cv::Mat &floor_plan,
+                                 const double min_separation,
+                                 const int threads )
+{
+    width = floor_plan.cols;
+    height = floor_plan.rows;
+
+    Thread_Pool pool( threads );
+    std::vector<long long> squared;
+    distance_transform( floor_plan, squared, pool );
+
+    distances = Mat( height, width, CV_32FC1 );
+    for (int y = 0; y < height; y++)
+    {
+        float *row = distances.ptr<float>( y );
+        for (int x = 0; x < width; x++)
+        {
+            long long d = squared[ (size_t)y * width + x ];
+            row[x] = ( d >= FAR_AWAY ) ? std::numeric_limits<float>::infinity() : (float)sqrt( (double)d );
+        }
+    }
+
+    ridge( squared, min_separation, pool );
+}
+
+// -----------------------------------------------------------------------
+
+void Generalized_Voronoi::distance_transform( const cv::Mat &floor_plan,
+                                              std::vector<long long> &squared,
+                                              Thread_Pool &pool )
+{
+    size_t size = (size_t)width * height;
+    int n = max( width, height );
+    squared.assign( size, FAR_AWAY );
+    features.assign( size, -1 );
+    std::vector<int> rows_of( size, -1 ); // Nearest obstacle row in the same column
+
+    // Scratch per thread: f, d, site, v, z
+    int threads = pool.get_thread_count();
+    std::vector<std::vector<long long>> f( threads, std::vector<long long>( n ) ), d( threads, std::vector<long long>( n ) );
+    std::vector<std::vector<int>> site( threads, std::vector<int>( n ) ), v( threads, std::vector<int>( n ) );
+    std::vector<std::vector<double>> z( threads, std::vector<double>( n + 1 ) );
+
+    // Down every column, distance to the nearest obstacle in that column
+    pool.parallel_for( width, [&]( size_t x, int thread )
+    {
+        for (int y = 0; y < height; y++)
+            f[thread][y] = ( floor_plan.at<Vec3b>( y, (int)x ) == Vec3b(0,0,0) ) ? 0 : FAR_AWAY; // If pixel black => obstacle
+        lower_envelope( f[thread].data(), height, d[thread].data(), site[thread].data(), v[thread].data(), z[thread].data() );
+        for (int y = 0; y < height; y++)
+        {
+            squared[ (size_t)y * width + x ] = d[thread][y];
+            rows_of[ (size_t)y * width + x ] = site[thread][y];
+        }
+    } );
+
+    // Along every row over the column distances, the winning column gives the obstacle
+    pool.parallel_for( height, [&]( size_t y, int thread )
+    {
+        long long *row = &squared[ y * width ];
+        std::copy( row, row + width, f[thread].begin() );
+        lower_envelope( f[thread].data(), width, row, site[thread].data(), v[thread].data(), z[thread].data() );
+        for (int x = 0; x < width; x++)
+        {
+            int column = site[thread][x];
+            if ( column >= 0 )
+                features[ y * width + x ] = rows_of[ y * width + column ] * width + column;
+        }
+    } );
+}
+
+// -----------------------------------------------------------------------
+
+void Generalized_Voronoi::ridge( const std::vector<long long> &squared,
+                                 const double min_separation,
+                                 Thread_Pool &pool )
+{
+    // Of two neighbors with far apart obstacles the one with more clearance is on the ridge,
+    // on equal clearance the first in row order. Every pixel only decides for itself.
+    double limit = min_separation * min_separation;
+    Mat ridge_img( height, width, CV_8UC1, Scalar(0) );
+    pool.parallel_for( height, [&]( size_t y, int )
+    {
+        uchar *row = ridge_img.ptr<uchar>( (int)y );
+        for (int x = 1; x < width-1; x++)
+        {
+            int id = (int)y * width + x;
+            if ( y == 0 || (int)y == height-1 || squared[id] == 0 || features[id] < 0 )
+                continue;
+
+            int fx = features[id] % width, fy = features[id] / width;
+            for (int k = 0; k < 4; k++)
+            {
+                int n = ( (int)y + DY[k] ) * width + x + DX[k];
+                if ( squared[n] == 0 || features[n] < 0 )
+                    continue;
+
+                double dx = fx - features[n] % width, dy = fy - features[n] / width;
+                if ( dx * dx + dy * dy > limit &&
+                     ( squared[id] > squared[n] || ( squared[id] == squared[n] && id < n ) ) )
+                {
+                    row[x] = 1;
+                    break;
+                }
+            }
+        }
+    } );
+
+    // One pixel wide like the thinning roadmap, the first and last row and column stay free
+    Voronoi_Diagram thinning;
+    thinning.get_thinned_img( ridge_img, roadmap );
+
+    roadmap_points.clear();
+    roadmap_clearance.clear();
+    for (int y = 0; y < height; y++)
+    {
+        const uchar *row = roadmap.ptr<uchar>( y );
+        for (int x = 0; x < width; x++)
+            if ( row[x] == 255 )
+            {
+                roadmap_points.push_back( Point( x, y ) );
+                roadmap_clearance.push_back( distances.at<float>( y, x ) );
+            }
+    }
+}
+
+// -----------------------------------------------------------------------
+
+void Generalized_Voronoi::get_voronoi_img( cv::Mat &dst ) const { dst = roadmap.clone(); }
+
+// -----------------------------------------------------------------------
+
+cv::Mat Generalized_Voronoi::draw_roadmap( const cv::Mat &floor_plan ) const
+{
+    Mat result = floor_plan.clone();
+    for ( auto& p : roadmap_points )
+        result.at<Vec3b>( p ) = Vec3b(0,0,255);
+    return result;
+}
+
+// -----------------------------------------------------------------------
+
+float Generalized_Voronoi::clearance( const cv::Point &p ) const
+{
+    if ( p.x < 0 || p.y < 0 || p.x >= width || p.y >= height )
+        return 0;
+    return distances.at<float>( p );
+}
+
+// -----------------------------------------------------------------------
+
+cv::Point Generalized_Voronoi::nearest_obstacle( const cv::Point &p ) const
+{
+    if ( p.x < 0 || p.y < 0 || p.x >= width || p.y >= height || features[ p.y * width + p.x ] < 0 )
+        return Point( -1, -1 );
+    int id = features[ p.y * width + p.x ];
+    return Point( id % width, id / width );
+}
+
+// -----------------------------------------------------------------------
+
+const cv::Mat &Generalized_Voronoi::get_clearance() const { return distances; }
+
+// -----------------------------------------------------------------------
+
+const std::vector<cv::Point> &Generalized_Voronoi::get_roadmap_points() const { return roadmap_points; }
+
+// -----------------------------------------------------------------------
+
+const std::vector<float> &Generalized_Voronoi::get_roadmap_clearance() const { return roadmap_clearance; }
+
+// -----------------------------------------------------------------------
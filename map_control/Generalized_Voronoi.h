@@ -0,0 +1,110 @@
+#ifndef GENERALIZED_VORONOI_H
+#define GENERALIZED_VORONOI_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace cv;
+
+class Thread_Pool;
+
+class Generalized_Voronoi
+{
+    /*************************************************************
+     *  Voronoi roadmap from an exact Euclidean distance transform
+     *  instead of iterative thinning.
+     *
+     *  The distance transform is the separable one of Felzenszwalb
+     *  and Huttenlocher: a lower envelope of parabolas down every
+     *  column, then along every row, O(N) in total. It also keeps
+     *  the site of the winning parabola, so every pixel knows its
+     *  nearest obstacle pixel ( the feature transform ). Columns and
+     *  rows are independent and spread over all cores.
+     *
+     *  The generalized Voronoi diagram runs where the nearest
+     *  obstacle jumps: between two neighbors whose nearest obstacle
+     *  pixels lie more than min_separation apart, the one further
+     *  from the obstacles is a ridge pixel. The ridge is at most two
+     *  pixels wide, it is thinned to one pixel with Voronoi_Diagram
+     *  so the roadmap looks like the thinning roadmap to the rest of
+     *  map_control.
+     *
+     *  Every roadmap pixel keeps its clearance, the exact distance
+     *  to the nearest obstacle pixel.
+     ************************************************************/
+    public:
+        Generalized_Voronoi();
+
+        /**
+         * @brief Generalized_Voronoi
+         * @param floor_plan => BGR image, black pixels are obstacles
+         * @param min_separation => Smallest distance in pixels between the
+         *      two nearest obstacles of a ridge, larger values drop the
+         *      short branches into wall corners and noise
+         * @param threads => 0 = one per core
+         */
+        Generalized_Voronoi( const cv::Mat &floor_plan,
+                             const double min_separation = 3,
+                             const int threads = 0 );
+
+        /**
+         * @brief build -> Distance transform and ridge of the floor plan
+         * @param floor_plan
+         * @param min_separation
+         * @param threads
+         */
+        void build( const cv::Mat &floor_plan,
+                    const double min_separation = 3,
+                    const int threads = 0 );
+
+        /**
+         * @brief get_voronoi_img -> Same format as Voronoi_Diagram::get_voronoi_img
+         * @param dst => CV_8UC1, 255 = roadmap
+         */
+        void get_voronoi_img( cv::Mat &dst ) const;
+
+        /**
+         * @brief draw_roadmap
+         * @param floor_plan
+         * @return Copy of floor_plan with the roadmap red
+         */
+        cv::Mat draw_roadmap( const cv::Mat &floor_plan ) const;
+
+        /**
+         * @brief clearance
+         * @param p
+         * @return Distance in pixels from p to the nearest obstacle pixel,
+         *      0 on obstacles, infinity if the plan has no obstacles
+         */
+        float clearance( const cv::Point &p ) const;
+
+        /**
+         * @brief nearest_obstacle
+         * @param p
+         * @return The nearest obstacle pixel, Point( -1, -1 ) if there is none
+         */
+        cv::Point nearest_obstacle( const cv::Point &p ) const;
+
+        const cv::Mat &get_clearance() const;                       // CV_32FC1, clearance of every pixel
+        const std::vector<cv::Point> &get_roadmap_points() const;
+        const std::vector<float> &get_roadmap_clearance() const;   // Same order as get_roadmap_points
+
+        ~Generalized_Voronoi();
+
+    private:
+        int width = 0, height = 0;
+        cv::Mat distances;                  // CV_32FC1
+        std::vector<int> features;          // y * width + x of the nearest obstacle, -1 = none
+        cv::Mat roadmap;                    // CV_8UC1, 255 = roadmap
+        std::vector<cv::Point> roadmap_points;
+        std::vector<float> roadmap_clearance;
+
+        void distance_transform( const cv::Mat &floor_plan, std::vector<long long> &squared, Thread_Pool &pool );
+        void ridge( const std::vector<long long> &squared, const double min_separation, Thread_Pool &pool );
+};
+
+#endif // GENERALIZED_VORONOI_H
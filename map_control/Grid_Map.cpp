@@ -0,0 +1,49 @@
+#include "Grid_Map.h"
+
+// -----------------------------------------------------------------------
+
+void load_blocked( const cv::Mat &img, const bool floor_plan, std::vector<uchar> &blocked )
+{
+    blocked.assign( (size_t)img.cols * img.rows, 0 );
+    for (int y = 0; y < img.rows; y++)
+    {
+        const Vec3b *row = img.ptr<Vec3b>( y );
+        for (int x = 0; x < img.cols; x++)
+            if ( floor_plan ? ( row[x] == Vec3b(0,0,0) )    // If pixel black => obstacle
+                            : ( row[x] != Vec3b(0,0,255) ) ) // If pixel not red => not roadmap
+                blocked[ (size_t)y * img.cols + x ] = 1;
+    }
+}
+
+// -----------------------------------------------------------------------
+
+void Fingerprint::add_image( const cv::Mat &img )
+{
+    add( img.cols );
+    add( img.rows );
+    for (int y = 0; y < img.rows; y++)
+    {
+        const Vec3b *row = img.ptr<Vec3b>( y );
+        for (int x = 0; x < img.cols; x++)
+            add_byte( ( row[x] == Vec3b(0,0,0) ) ? 0 : ( row[x] == Vec3b(0,0,255) ) ? 1 : 2 );
+    }
+}
+
+// -----------------------------------------------------------------------
+
+void write_header( std::ostream &out, const char *magic, const unsigned long long fingerprint )
+{
+    out.write( magic, 4 );
+    write_binary( out, fingerprint );
+}
+
+// -----------------------------------------------------------------------
+
+bool read_header( std::istream &in, const char *magic, const unsigned long long fingerprint )
+{
+    char file_magic[4];
+    unsigned long long file_fingerprint = 0;
+    in.read( file_magic, 4 );
+    read_binary( in, file_fingerprint );
+    return in && string( file_magic, 4 ) == string( magic, 4 ) && file_fingerprint == fingerprint;
+}
@@ -0,0 +1,115 @@
+#ifndef GRID_MAP_H
+#define GRID_MAP_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "A_Star.h"
+
+using namespace std;
+using namespace cv;
+
+/***************************************
+ *  Shared by the grid modules: the neighbor order and step costs
+ *  of A_Star, the blocked mask of a map image, and the fingerprint
+ *  and binary helpers of the files the tables are saved in.
+ ***************************************/
+
+// L, T, R, B, LT, RT, RB, LB => same order as A_Star::neighbors
+const int NEIGHBOR_DX[8] = { -1,  0, 1, 0, -1,  1, 1, -1 };
+const int NEIGHBOR_DY[8] = {  0, -1, 0, 1, -1, -1, 1,  1 };
+const int NEIGHBOR_COST[8] = { G_DIRECT, G_DIRECT, G_DIRECT, G_DIRECT, G_SKEW, G_SKEW, G_SKEW, G_SKEW };
+
+/**
+ * @brief load_blocked -> One byte per pixel, 1 = blocked
+ * @param img => BGR image
+ * @param floor_plan => Same as A_Star, true = black pixels are
+ *      blocked, false = everything but red roadmap pixels is blocked
+ * @param blocked => Resized to img.cols * img.rows
+ */
+void load_blocked( const cv::Mat &img, const bool floor_plan, std::vector<uchar> &blocked );
+
+class Fingerprint
+{
+    /*************************************************************
+     *  FNV-1a hash of what a table was built from. Saved with the
+     *  table, so load() can refuse a file made from another map.
+     ************************************************************/
+    public:
+        /**
+         * @brief add -> All 8 bytes of value
+         */
+        void add( const long long value )
+        {
+            for (int i = 0; i < 8; i++)
+                add_byte( (uchar)( ( value >> ( 8 * i ) ) & 0xff ) );
+        }
+
+        void add_byte( const uchar value )
+        {
+            hash ^= value;
+            hash *= 1099511628211ULL;
+        }
+
+        /**
+         * @brief add_image -> The size and the class of every pixel
+         *      ( obstacle, roadmap or free )
+         * @param img => BGR image
+         */
+        void add_image( const cv::Mat &img );
+
+        unsigned long long get() const { return hash; }
+
+    private:
+        unsigned long long hash = 14695981039346656037ULL;
+};
+
+/**
+ * @brief write_header -> Magic and fingerprint in front of a saved table
+ * @param out
+ * @param magic => 4 characters, names the file type and version
+ * @param fingerprint
+ */
+void write_header( std::ostream &out, const char *magic, const unsigned long long fingerprint );
+
+/**
+ * @brief read_header
+ * @param in
+ * @param magic => Same as write_header
+ * @param fingerprint => Fingerprint of the map the table is loaded for
+ * @return false if the file is of another type or made from another map
+ */
+bool read_header( std::istream &in, const char *magic, const unsigned long long fingerprint );
+
+template<class T>
+void write_binary( std::ostream &out, const T &value )
+{
+    out.write( (const char *)&value, sizeof(T) );
+}
+
+template<class T>
+void write_binary( std::ostream &out, const std::vector<T> &values )
+{
+    out.write( (const char *)values.data(), values.size() * sizeof(T) );
+}
+
+template<class T>
+void read_binary( std::istream &in, T &value )
+{
+    in.read( (char *)&value, sizeof(T) );
+}
+
+/**
+ * @brief read_binary -> Fills values, the size must be set by the caller
+ */
+template<class T>
+void read_binary( std::istream &in, std::vector<T> &values )
+{
+    in.read( (char *)values.data(), values.size() * sizeof(T) );
+}
+
+#endif // GRID_MAP_H
@@ -0,0 +1,268 @@
+#include "Landmark_Table.h"
+#include "Grid_Map.h"
+#include "Thread_Pool.h"
+
+const int Landmark_Table::UNREACHABLE;
+
+// -----------------------------------------------------------------------
+
+Landmark_Table::Landmark_Table() {}
+
+// -----------------------------------------------------------------------
+
+Landmark_Table::Landmark_Table( const cv::Mat &img,
+                                const int count,
+                                const bool floor_plan,
+                                const std::vector<cv::Point> &seeds,
+                                const int threads )
+{
+    build( img, count, floor_plan, seeds, threads );
+}
+
+// -----------------------------------------------------------------------
+
+Landmark_Table::~Landmark_Table() {}
+
+// -----------------------------------------------------------------------
+
+void Landmark_Table::build( const cv::Mat &img,
+                            const int count,
+                            const bool floor_plan,
+                            const std::vector<cv::Point> &seeds,
+                            const int threads )
+{
+    width = img.cols;
+    height = img.rows;
+    this->floor_plan = floor_plan;
+    fingerprint = make_fingerprint( img, floor_plan );
+    load_blocked( img, floor_plan, blocked );
+    size_t size = (size_t)width * height;
+
+    landmarks.clear();
+    for ( auto& p : seeds )
+        if ( (int)landmarks.size() < count && is_free( p ) &&
+             std::find( landmarks.begin(), landmarks.end(), p ) == landmarks.end() )
+            landmarks.push_back( p );
+
+    if ( count <= 0 )
+    {
+        distances.clear();
+        return;
+    }
+
+    // The seeds are independent, one Dijkstra per task
+    distances.assign( landmarks.size() * size, UNREACHABLE );
+    Thread_Pool pool( threads );
+    std::vector<Index_Heap> open_lists( pool.get_thread_count() );
+    std::vector<std::vector<int>> g( pool.get_thread_count() );
+    for (size_t t = 0; t < open_lists.size(); t++)
+    {
+        open_lists[t].reserve( size );
+        g[t].resize( size );
+    }
+    pool.parallel_for( landmarks.size(), [&]( size_t k, int thread )
+    {
+        dijkstra( landmarks[k], open_lists[thread], g[thread] );
+        for (size_t id = 0; id < size; id++) // Only this landmark's column is written
+            distances[ id * landmarks.size() + k ] = g[thread][id];
+    } );
+
+    // Farthest point sampling, each new landmark needs the distances of the ones before
+    std::vector<int> nearest( size, UNREACHABLE );
+    for (size_t k = 0; k < landmarks.size(); k++)
+        for (size_t id = 0; id < size; id++)
+            nearest[id] = min( nearest[id], distances[ id * landmarks.size() + k ] );
+
+    while ( (int)landmarks.size() < count )
+    {
+        size_t far = 0;
+        if ( landmarks.empty() )
+        {
+            // No seeds => the pixel farthest from the first free pixel, an end of the map
+            size_t first = std::find( blocked.begin(), blocked.end(), 0 ) - blocked.begin();
+            if ( first == size ) // No free pixel
+                break;
+
+            dijkstra( Point( (int)( first % width ), (int)( first / width ) ), open_lists[0], g[0] );
+            far = first;
+            for (size_t id = 0; id < size; id++)
+                if ( g[0][id] != UNREACHABLE && g[0][id] > g[0][far] )
+                    far = id;
+        }
+        else
+        {
+            // Pixels no landmark reaches come first, so every part of the map gets one
+            long long best = -1;
+            for (size_t id = 0; id < size; id++)
+                if ( !blocked[id] && (long long)nearest[id] > best )
+                {
+                    best = nearest[id];
+                    far = id;
+                }
+            if ( best <= 0 ) // Every free pixel is a landmark
+                break;
+        }
+
+        // Widen the table by one column
+        size_t k = landmarks.size();
+        landmarks.push_back( Point( (int)( far % width ), (int)( far / width ) ) );
+        std::vector<int> wider( landmarks.size() * size );
+        for (size_t id = 0; id < size; id++)
+            std::copy( distances.begin() + id * k,
+                       distances.begin() + ( id + 1 ) * k,
+                       wider.begin() + id * landmarks.size() );
+        distances.swap( wider );
+
+        dijkstra( landmarks[k], open_lists[0], g[0] );
+        for (size_t id = 0; id < size; id++)
+        {
+            distances[ id * landmarks.size() + k ] = g[0][id];
+            nearest[id] = min( nearest[id], g[0][id] );
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+
+void Landmark_Table::dijkstra( const cv::Point &source, Index_Heap &open_list, std::vector<int> &g ) const
+{
+    std::fill( g.begin(), g.end(), UNREACHABLE );
+    open_list.clear();
+    g[ source.y * width + source.x ] = 0;
+    open_list.push( source.y * width + source.x, 0 );
+
+    while ( !open_list.empty() )
+    {
+        int u = open_list.pop();
+        int x = u % width, y = u / width;
+        for (int d = 0; d < 8; d++)
+        {
+            int nx = x + NEIGHBOR_DX[d], ny = y + NEIGHBOR_DY[d];
+            if ( nx < 0 || ny < 0 || nx >= width || ny >= height )
+                continue;
+
+            int w = ny * width + nx;
+            int new_g = g[u] + NEIGHBOR_COST[d];
+            if ( !blocked[w] && new_g < g[w] )
+            {
+                g[w] = new_g;
+                open_list.push( w, new_g );
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+
+unsigned long long Landmark_Table::make_fingerprint( const cv::Mat &img, const bool floor_plan )
+{
+    Fingerprint hash;
+    hash.add_image( img );
+    hash.add( floor_plan );
+    return hash.get();
+}
+
+// -----------------------------------------------------------------------
+
+bool Landmark_Table::save( const std::string &file ) const
+{
+    ofstream out( file, ios::binary );
+    if ( !out )
+        return false;
+
+    write_header( out, "ALT2", fingerprint );
+    write_binary( out, width );
+    write_binary( out, height );
+    write_binary( out, (int)landmarks.size() );
+    for ( auto& p : landmarks )
+    {
+        write_binary( out, p.x );
+        write_binary( out, p.y );
+    }
+    write_binary( out, distances );
+    return (bool)out;
+}
+
+// -----------------------------------------------------------------------
+
+bool Landmark_Table::load( const std::string &file, const cv::Mat &img, const bool floor_plan )
+{
+    unsigned long long map_fingerprint = make_fingerprint( img, floor_plan );
+    ifstream in( file, ios::binary );
+    if ( !in || !read_header( in, "ALT2", map_fingerprint ) )
+        return false; // Made from another map
+
+    int file_width = 0, file_height = 0, count = 0;
+    read_binary( in, file_width );
+    read_binary( in, file_height );
+    read_binary( in, count );
+    if ( !in || file_width != img.cols || file_height != img.rows || count < 0 )
+        return false;
+
+    std::vector<cv::Point> file_landmarks( count );
+    for ( auto& p : file_landmarks )
+    {
+        read_binary( in, p.x );
+        read_binary( in, p.y );
+    }
+    std::vector<int> file_distances( (size_t)count * file_width * file_height );
+    read_binary( in, file_distances );
+    if ( !in )
+        return false;
+
+    width = file_width;
+    height = file_height;
+    this->floor_plan = floor_plan;
+    fingerprint = map_fingerprint;
+    landmarks.swap( file_landmarks );
+    distances.swap( file_distances );
+    load_blocked( img, floor_plan, blocked );
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+int Landmark_Table::lower_bound( const cv::Point &p1, const cv::Point &p2 ) const
+{
+    return lower_bound( p1.y * width + p1.x, p2.y * width + p2.x );
+}
+
+// -----------------------------------------------------------------------
+
+int Landmark_Table::distance( const int landmark, const cv::Point &p ) const
+{
+    return distances[ (size_t)( p.y * width + p.x ) * landmarks.size() + landmark ];
+}
+
+// -----------------------------------------------------------------------
+
+bool Landmark_Table::is_free( const cv::Point &p ) const
+{
+    return p.x >= 0 && p.y >= 0 && p.x < width && p.y < height && !blocked[ p.y * width + p.x ];
+}
+
+// -----------------------------------------------------------------------
+
+bool Landmark_Table::matches( const cv::Mat &img, const bool floor_plan ) const
+{
+    return width == img.cols && height == img.rows && this->floor_plan == floor_plan &&
+           fingerprint == make_fingerprint( img, floor_plan );
+}
+
+// -----------------------------------------------------------------------
+
+const std::vector<cv::Point> &Landmark_Table::get_landmarks() const { return landmarks; }
+
+// -----------------------------------------------------------------------
+
+bool Landmark_Table::is_floor_plan() const { return floor_plan; }
+
+// -----------------------------------------------------------------------
+
+int Landmark_Table::get_width() const { return width; }
+
+// -----------------------------------------------------------------------
+
+int Landmark_Table::get_height() const { return height; }
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,164 @@
+#ifndef LANDMARK_TABLE_H
+#define LANDMARK_TABLE_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <climits>
+
+#include "Open_List.h"
+
+using namespace std;
+using namespace cv;
+
+class Landmark_Table
+{
+    /*************************************************************
+     *  Exact grid distances from a few landmarks to every free
+     *  pixel, for the ALT heuristic ( A*, Landmarks and Triangle
+     *  inequality, Goldberg & Harrelson 2005 ).
+     *
+     *  For a landmark L the triangle inequality gives
+     *      d( n, goal ) >= | d( L, goal ) - d( L, n ) |
+     *  and the largest of these over all landmarks is a consistent
+     *  heuristic. Behind a wall or at the end of a corridor it is
+     *  much closer to the real distance than the octile distance,
+     *  so A_Star expands fewer nodes for the same optimal path.
+     *
+     *  The landmarks are the given seeds ( e.g. room centers from
+     *  DetectRooms ), then farthest point sampling adds the free
+     *  pixel farthest from all landmarks so far until there are
+     *  enough. One Dijkstra per landmark over the same 8-connected
+     *  grid and step costs as A_Star, the seeds run on all cores.
+     *
+     *  The distances of one pixel are stored next to each other, so
+     *  a heuristic lookup reads one cache line. The table can be
+     *  saved next to the map, a fingerprint makes sure it belongs
+     *  to it.
+     ************************************************************/
+    public:
+        static const int UNREACHABLE = INT_MAX;
+
+        Landmark_Table();
+
+        /**
+         * @brief Landmark_Table
+         * @param img => BGR image
+         * @param count => Number of landmarks, 0 = octile distance only
+         * @param floor_plan => Same as A_Star, true = black pixels are
+         *      blocked, false = everything but red roadmap pixels is blocked
+         * @param seeds => First landmarks, blocked seeds are skipped
+         * @param threads => 0 = one per core
+         */
+        Landmark_Table( const cv::Mat &img,
+                        const int count,
+                        const bool floor_plan = false,
+                        const std::vector<cv::Point> &seeds = std::vector<cv::Point>(),
+                        const int threads = 0 );
+
+        /**
+         * @brief build -> Choose the landmarks and compute their distances
+         * @param img
+         * @param count
+         * @param floor_plan
+         * @param seeds
+         * @param threads
+         */
+        void build( const cv::Mat &img,
+                    const int count,
+                    const bool floor_plan = false,
+                    const std::vector<cv::Point> &seeds = std::vector<cv::Point>(),
+                    const int threads = 0 );
+
+        /**
+         * @brief save -> Write the table to a binary file
+         * @param file => e.g. "big_floor_plan.alt"
+         * @return
+         */
+        bool save( const std::string &file ) const;
+
+        /**
+         * @brief load -> Read a table written by save()
+         * @param file
+         * @param img => The image the table was built from
+         * @param floor_plan => The mode the table was built with
+         * @return false if the file is missing or belongs to another map
+         */
+        bool load( const std::string &file, const cv::Mat &img, const bool floor_plan = false );
+
+        /**
+         * @brief lower_bound -> ALT heuristic
+         * @param id1 => y * width + x
+         * @param id2 => y * width + x
+         * @return Largest | d( L, id2 ) - d( L, id1 ) | over the landmarks
+         *      that reach both pixels, 0 if there is none
+         */
+        int lower_bound( const int id1, const int id2 ) const
+        {
+            const int *a = distances.data() + (size_t)id1 * landmarks.size();
+            const int *b = distances.data() + (size_t)id2 * landmarks.size();
+            int best = 0;
+            for (size_t k = 0; k < landmarks.size(); k++)
+                if ( a[k] != UNREACHABLE && b[k] != UNREACHABLE )
+                    best = max( best, abs( a[k] - b[k] ) );
+            return best;
+        }
+
+        int lower_bound( const cv::Point &p1, const cv::Point &p2 ) const;
+
+        /**
+         * @brief distance
+         * @param landmark => Index in get_landmarks()
+         * @param p
+         * @return Grid cost from the landmark to p, UNREACHABLE if blocked
+         *      or in another part of the map
+         */
+        int distance( const int landmark, const cv::Point &p ) const;
+
+        /**
+         * @brief is_free
+         * @param p
+         * @return true if p is a node of the grid the table was built on
+         */
+        bool is_free( const cv::Point &p ) const;
+
+        /**
+         * @brief matches
+         * @param img
+         * @param floor_plan
+         * @return true if the table was built from this image in this mode,
+         *      compares the fingerprint so an edited map of the same size fails
+         */
+        bool matches( const cv::Mat &img, const bool floor_plan ) const;
+
+        const std::vector<cv::Point> &get_landmarks() const;
+        bool is_floor_plan() const;
+        int get_width() const;
+        int get_height() const;
+
+        ~Landmark_Table();
+
+    private:
+        int width = 0, height = 0;
+        bool floor_plan = false;
+        unsigned long long fingerprint = 0;
+        std::vector<cv::Point> landmarks;
+        std::vector<uchar> blocked;
+        std::vector<int> distances;     // distances[ id * landmarks + k ], UNREACHABLE = no path
+
+        static unsigned long long make_fingerprint( const cv::Mat &img, const bool floor_plan );
+
+        /**
+         * @brief dijkstra -> Grid cost from source to every pixel
+         * @param source
+         * @param open_list => Workspace of the calling thread
+         * @param g => Filled with the costs, one entry per pixel
+         */
+        void dijkstra( const cv::Point &source, Index_Heap &open_list, std::vector<int> &g ) const;
+};
+
+#endif // LANDMARK_TABLE_H
@@ -0,0 +1,159 @@
+#include "Line_Of_Sight.h"
+
+// -----------------------------------------------------------------------
+
+/**
+ * @brief walk_line -> Bresenham walk in the same pixel order as
+ *      cv::LineIterator( img, a, b, 8 ), from a to b
+ * @param a
+ * @param b
+ * @param size => Size of the map, the line is clipped to it
+ * @param pixel_step => Offset of one pixel to the right
+ * @param row_step => Offset of one row down
+ * @param obstacle => obstacle( offset ) is true for an obstacle
+ * @return true at the first obstacle, false if the line is clear
+ */
+template<class Obstacle>
+static bool walk_line( cv::Point a, cv::Point b, const cv::Size &size,
+                       const long pixel_step, const long row_step, Obstacle obstacle )
+{
+    if ( (unsigned)a.x >= (unsigned)size.width || (unsigned)a.y >= (unsigned)size.height ||
+         (unsigned)b.x >= (unsigned)size.width || (unsigned)b.y >= (unsigned)size.height )
+    {
+        if ( !clipLine( size, a, b ) ) // Completely outside => no pixels
+            return false;
+    }
+
+    // Signed steps like LineIterator, ties in the error are broken in the walking direction
+    int dx = b.x - a.x, dy = b.y - a.y;
+    long major = pixel_step, minor = row_step;
+    if ( dx < 0 )
+    {
+        dx = -dx;
+        major = -major;
+    }
+    if ( dy < 0 )
+    {
+        dy = -dy;
+        minor = -minor;
+    }
+    if ( dy > dx ) // Steep => step rows and sometimes columns
+    {
+        std::swap( dx, dy );
+        std::swap( major, minor );
+    }
+
+    long offset = a.y * row_step + a.x * pixel_step;
+    int err = dx - ( dy + dy );
+    for (int i = 0; i <= dx; i++)
+    {
+        if ( obstacle( offset ) )
+            return true;
+
+        if ( err < 0 )
+        {
+            err += dx + dx - ( dy + dy );
+            offset += major + minor;
+        }
+        else
+        {
+            err -= dy + dy;
+            offset += major;
+        }
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------
+
+Line_Of_Sight::Line_Of_Sight() {}
+
+// -----------------------------------------------------------------------
+
+Line_Of_Sight::Line_Of_Sight( const cv::Mat &img, const cv::Scalar &obstacle ) { set_map( img, obstacle ); }
+
+// -----------------------------------------------------------------------
+
+Line_Of_Sight::~Line_Of_Sight() {}
+
+// -----------------------------------------------------------------------
+
+void Line_Of_Sight::set_map( const cv::Mat &img, const cv::Scalar &obstacle )
+{
+    width = img.cols;
+    height = img.rows;
+    obstacles.assign( (size_t)width * height, false );
+
+    int channels = img.channels();
+    uchar color[3] = { (uchar)obstacle[0], (uchar)obstacle[1], (uchar)obstacle[2] };
+    for (int y = 0; y < height; y++)
+    {
+        const uchar *row = img.ptr( y );
+        for (int x = 0; x < width; x++, row += channels)
+            if ( row[0] == color[0] &&
+                 ( channels == 1 || ( row[1] == color[1] && row[2] == color[2] ) ) )
+                obstacles.set( (size_t)y * width + x );
+    }
+}
+
+// -----------------------------------------------------------------------
+
+bool Line_Of_Sight::visible( const cv::Point &a, const cv::Point &b ) const
+{
+    const Bit_Plane &mask = obstacles;
+    return !walk_line( a, b, Size( width, height ), 1, width,
+                       [&mask]( const long offset ) { return mask.test( offset ); } );
+}
+
+// -----------------------------------------------------------------------
+
+int Line_Of_Sight::visible_from( const cv::Point &source,
+                                 const std::vector<cv::Point> &targets,
+                                 std::vector<uchar> &visible ) const
+{
+    int amount = 0;
+    visible.resize( targets.size() );
+    for (size_t i = 0; i < targets.size(); i++)
+    {
+        visible[i] = this->visible( source, targets[i] );
+        amount += visible[i];
+    }
+    return amount;
+}
+
+// -----------------------------------------------------------------------
+
+bool Line_Of_Sight::is_obstacle( const cv::Point &p ) const
+{
+    return obstacles.test( (size_t)p.y * width + p.x );
+}
+
+// -----------------------------------------------------------------------
+
+int Line_Of_Sight::get_width() const { return width; }
+
+// -----------------------------------------------------------------------
+
+int Line_Of_Sight::get_height() const { return height; }
+
+// -----------------------------------------------------------------------
+
+bool Line_Of_Sight::obstacle_on_line( const cv::Mat &img,
+                                      const cv::Point &a,
+                                      const cv::Point &b,
+                                      const cv::Scalar &obstacle )
+{
+    const uchar *data = img.data;
+    uchar color[3] = { (uchar)obstacle[0], (uchar)obstacle[1], (uchar)obstacle[2] };
+
+    if ( img.channels() == 1 )
+        return walk_line( a, b, img.size(), 1, (long)img.step,
+                          [&]( const long offset ) { return data[offset] == color[0]; } );
+
+    return walk_line( a, b, img.size(), 3, (long)img.step,
+                      [&]( const long offset ) { return data[offset] == color[0] &&
+                                                        data[offset + 1] == color[1] &&
+                                                        data[offset + 2] == color[2]; } );
+}
+
+// -----------------------------------------------------------------------
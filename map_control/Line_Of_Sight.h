@@ -0,0 +1,98 @@
+#ifndef LINE_OF_SIGHT_H
+#define LINE_OF_SIGHT_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+#include "opencv2/imgproc.hpp"
+
+#include <vector>
+
+#include "Bit_Plane.h"
+
+using namespace std;
+using namespace cv;
+
+class Line_Of_Sight
+{
+    /*************************************************************
+     *  Visibility test shared by the planners. A straight line is
+     *  clear if none of its pixels is an obstacle.
+     *
+     *  The line is walked with integer Bresenham steps that visit
+     *  exactly the pixels of cv::LineIterator( img, a, b, 8 ) in the
+     *  same order, from a to b. Bresenham breaks ties differently in
+     *  the two directions, so visible( a, b ) and visible( b, a ) may
+     *  differ on a pixel. The walk stops at the first obstacle and
+     *  never allocates.
+     *
+     *  The object keeps the obstacles of a map as a bit-packed mask,
+     *  for maps that are tested many times. The static functions
+     *  test a Mat directly, for maps that change between tests.
+     *
+     *  An obstacle is a pixel equal to the obstacle color in every
+     *  channel of an 8 bit, 1 or 3 channel image.
+     ************************************************************/
+    public:
+        Line_Of_Sight();
+
+        /**
+         * @brief Line_Of_Sight
+         * @param img => 8 bit gray or BGR image
+         * @param obstacle => Color of the obstacle pixels
+         */
+        Line_Of_Sight( const cv::Mat &img, const cv::Scalar &obstacle = Scalar(0,0,0) );
+
+        /**
+         * @brief set_map -> Build the obstacle mask
+         * @param img
+         * @param obstacle
+         */
+        void set_map( const cv::Mat &img, const cv::Scalar &obstacle = Scalar(0,0,0) );
+
+        /**
+         * @brief visible
+         * @param a
+         * @param b
+         * @return true if no pixel on the line from a to b is an obstacle.
+         *      The line is clipped to the map like LineIterator does.
+         */
+        bool visible( const cv::Point &a, const cv::Point &b ) const;
+
+        /**
+         * @brief visible_from -> Test one source against many targets
+         * @param source
+         * @param targets
+         * @param visible => Resized to targets.size(), 1 if targets[i]
+         *      is visible from source
+         * @return Number of visible targets
+         */
+        int visible_from( const cv::Point &source,
+                          const std::vector<cv::Point> &targets,
+                          std::vector<uchar> &visible ) const;
+
+        bool is_obstacle( const cv::Point &p ) const;
+
+        int get_width() const;
+        int get_height() const;
+
+        /**
+         * @brief obstacle_on_line -> Test a Mat without building a mask
+         * @param img => 8 bit gray or BGR image
+         * @param a
+         * @param b
+         * @param obstacle => Color of the obstacle pixels
+         * @return true if a pixel on the line is an obstacle
+         */
+        static bool obstacle_on_line( const cv::Mat &img,
+                                      const cv::Point &a,
+                                      const cv::Point &b,
+                                      const cv::Scalar &obstacle = Scalar(0,0,0) );
+
+        ~Line_Of_Sight();
+
+    private:
+        int width = 0, height = 0;
+        Bit_Plane obstacles;    // Index y * width + x
+};
+
+#endif // LINE_OF_SIGHT_H
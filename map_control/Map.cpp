@@ -716,25 +716,9 @@ tuple<string,Point> Map::getClosestPointRight(vector<Point> samex, vector<Point>
         return make_tuple("Same x",closestPointSamex);
 }
 
-vector<Point> Map::get_points(LineIterator &it)
-{
-    vector<Point> v(it.count);
-    for (int i = 0; i < it.count; i++, it++) {
-        v[i] = it.pos();
-    }
-    return v;
-}
-
 bool Map::obstacleDetectedWithLine(Point start, Point end)
 {
-    LineIterator it(this->map, start, end, 8);
-    vector<Point> v = get_points(it);
-    for (size_t i = 0; i < v.size(); i++) {
-        if ( (int)this->map.at<uchar>(v[i]) == 255 ) {
-            return true;
-        }
-    }
-    return false;
+    return Line_Of_Sight::obstacle_on_line(this->map, start, end, Scalar(255));
 }
 
 bool Map::findNremovePoint(vector<Point> &list, Point point)
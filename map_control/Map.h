@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <Cell.h>
 #include <Cellpoint.h>
+#include "Line_Of_Sight.h"
 //#include <Link.h>
 using namespace std;
 using namespace cv;
@@ -72,7 +73,6 @@ private:
     tuple<string,Point> getClosestPointLeft(vector<Point> samex, vector<Point> nonSamex, Point cellPoint);
     tuple<string, Point> getClosestPointRight(vector<Point> samex, vector<Point> nonSamex, Point cellPoint);
     bool obstacleDetectedWithLine(Point start, Point end);
-    vector<Point> get_points(LineIterator &it);
     bool isRightSameCellpoint(vector<Cellpoint> list, Point cellpoint, Point connectionPointRight);
     bool isLeftSameCellpoint(vector<Cellpoint> list, Point cellpoint, Point connectionPointLeft);
     bool findNremovePoint(vector<Point> &list, Point point);
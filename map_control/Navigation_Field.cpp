@@ -0,0 +1,248 @@
+#include "Navigation_Field.h"
+#include "Grid_Map.h"
+#include "Thread_Pool.h"
+
+#include <atomic>
+
+// Buckets in the ring, a step never reaches further than G_SKEW ahead
+static const int RING = G_SKEW + 1;
+
+// Smaller buckets are expanded by the calling thread, the pool would only add overhead
+static const size_t PARALLEL_CHUNK = 1024;
+
+const int Navigation_Field::UNREACHABLE;
+const uchar Navigation_Field::NO_STEP;
+
+// -----------------------------------------------------------------------
+
+Navigation_Field::Navigation_Field() {}
+
+// -----------------------------------------------------------------------
+
+Navigation_Field::Navigation_Field( const cv::Mat &img,
+                                    const cv::Point &goal,
+                                    const bool floor_plan,
+                                    const int threads )
+{
+    build( img, goal, floor_plan, threads );
+}
+
+// -----------------------------------------------------------------------
+
+Navigation_Field::~Navigation_Field() {}
+
+// -----------------------------------------------------------------------
+
+void Navigation_Field::build( const cv::Mat &img,
+                              const cv::Point &goal,
+                              const bool floor_plan,
+                              const int threads )
+{
+    Thread_Pool pool( threads );
+    build( img, goal, floor_plan, pool );
+}
+
+// -----------------------------------------------------------------------
+
+void Navigation_Field::build( const cv::Mat &img,
+                              const cv::Point &goal,
+                              const bool floor_plan,
+                              Thread_Pool &pool )
+{
+    width = img.cols;
+    height = img.rows;
+    this->goal = goal;
+    size_t size = (size_t)width * height;
+
+    load_blocked( img, floor_plan, blocked );
+
+    distances.assign( size, UNREACHABLE );
+    steps.assign( size, NO_STEP );
+    if ( goal.x < 0 || goal.y < 0 || goal.x >= width || goal.y >= height )
+        return;
+    blocked[ goal.y * width + goal.x ] = 0; // The goal is free even if it is not on the roadmap
+
+    std::vector<std::atomic<int>> cost( size );
+    for ( auto& c : cost )
+        c.store( UNREACHABLE, std::memory_order_relaxed );
+
+    std::vector<std::vector<int>> ring( RING );
+    std::vector<std::vector<std::vector<int>>> outbox( pool.get_thread_count(), std::vector<std::vector<int>>( RING ) );
+    std::vector<int> frontier;
+
+    cost[ goal.y * width + goal.x ].store( 0, std::memory_order_relaxed );
+    ring[0].push_back( goal.y * width + goal.x );
+    size_t pending = 1;
+
+    // The costs of a bucket are final, its pixels only lower the costs of later buckets
+    auto expand = [&]( const int d, const size_t begin, const size_t end, const int thread )
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            int u = frontier[i];
+            if ( cost[u].load( std::memory_order_relaxed ) != d ) // Lowered after it was put in this bucket
+                continue;
+
+            int x = u % width, y = u / width;
+            for (int k = 0; k < 8; k++)
+            {
+                int nx = x + NEIGHBOR_DX[k], ny = y + NEIGHBOR_DY[k];
+                if ( nx < 0 || ny < 0 || nx >= width || ny >= height )
+                    continue;
+
+                int w = ny * width + nx;
+                if ( blocked[w] )
+                    continue;
+
+                int new_cost = d + NEIGHBOR_COST[k];
+                int old = cost[w].load( std::memory_order_relaxed );
+                while ( new_cost < old && !cost[w].compare_exchange_weak( old, new_cost, std::memory_order_relaxed ) ) {}
+                if ( new_cost < old )
+                    outbox[thread][ new_cost % RING ].push_back( w );
+            }
+        }
+    };
+
+    for (int d = 0; pending > 0; d++)
+    {
+        if ( ring[ d % RING ].empty() )
+            continue;
+
+        frontier.clear();
+        frontier.swap( ring[ d % RING ] );
+        pending -= frontier.size();
+
+        size_t n = frontier.size();
+        if ( n < PARALLEL_CHUNK )
+            expand( d, 0, n, 0 );
+        else
+            pool.parallel_for( ( n + PARALLEL_CHUNK - 1 ) / PARALLEL_CHUNK, [&]( size_t c, int thread )
+            {
+                expand( d, c * PARALLEL_CHUNK, min( n, ( c + 1 ) * PARALLEL_CHUNK ), thread );
+            } );
+
+        for ( auto& boxes : outbox )
+            for (int r = 0; r < RING; r++)
+            {
+                ring[r].insert( ring[r].end(), boxes[r].begin(), boxes[r].end() );
+                pending += boxes[r].size();
+                boxes[r].clear();
+            }
+    }
+
+    // Steps from the final costs, the first neighbor on a shortest path in A_Star order
+    for (size_t id = 0; id < size; id++)
+        distances[id] = cost[id].load( std::memory_order_relaxed );
+
+    pool.parallel_for( height, [&]( size_t y, int )
+    {
+        for (int x = 0; x < width; x++)
+        {
+            int u = (int)y * width + x;
+            if ( distances[u] == UNREACHABLE || distances[u] == 0 )
+                continue;
+
+            for (int k = 0; k < 8; k++)
+            {
+                int nx = x + NEIGHBOR_DX[k], ny = (int)y + NEIGHBOR_DY[k];
+                if ( nx < 0 || ny < 0 || nx >= width || ny >= height )
+                    continue;
+
+                int w = ny * width + nx;
+                if ( distances[w] != UNREACHABLE && distances[w] + NEIGHBOR_COST[k] == distances[u] )
+                {
+                    steps[u] = (uchar)k;
+                    break;
+                }
+            }
+        }
+    } );
+}
+
+// -----------------------------------------------------------------------
+
+bool Navigation_Field::find_path( const cv::Point &start, std::vector<cv::Point> &path ) const
+{
+    path.clear();
+    if ( start == goal || distance( start ) == UNREACHABLE )
+        return false;
+
+    // Every step lowers the cost, so this ends at the goal
+    for (cv::Point p = start; p != goal; )
+    {
+        uchar k = steps[ p.y * width + p.x ];
+        p += Point( NEIGHBOR_DX[k], NEIGHBOR_DY[k] );
+        path.push_back( p );
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+int Navigation_Field::distance( const cv::Point &p ) const
+{
+    if ( p.x < 0 || p.y < 0 || p.x >= width || p.y >= height )
+        return UNREACHABLE;
+    return distances[ p.y * width + p.x ];
+}
+
+// -----------------------------------------------------------------------
+
+cv::Point Navigation_Field::next_step( const cv::Point &p ) const
+{
+    if ( distance( p ) == UNREACHABLE || p == goal )
+        return p;
+    uchar k = steps[ p.y * width + p.x ];
+    return p + Point( NEIGHBOR_DX[k], NEIGHBOR_DY[k] );
+}
+
+// -----------------------------------------------------------------------
+
+cv::Mat Navigation_Field::draw() const
+{
+    int highest = 1;
+    for ( auto& d : distances )
+        if ( d != UNREACHABLE )
+            highest = max( highest, d );
+
+    Mat result( height, width, CV_8UC3, Scalar(0,0,0) );
+    for (int y = 0; y < height; y++)
+    {
+        Vec3b *row = result.ptr<Vec3b>( y );
+        for (int x = 0; x < width; x++)
+        {
+            int id = y * width + x;
+            if ( blocked[id] )
+                continue;
+
+            if ( distances[id] == UNREACHABLE )
+                row[x] = Vec3b(128,128,128);
+            else
+            {
+                int t = (int)( 255LL * distances[id] / highest );
+                row[x] = Vec3b( (uchar)( 255 - t ), 0, (uchar)t );
+            }
+        }
+    }
+    if ( distance( goal ) == 0 )
+        result.at<Vec3b>( goal ) = Vec3b(0,255,0);
+    return result;
+}
+
+// -----------------------------------------------------------------------
+
+const std::vector<int> &Navigation_Field::get_distances() const { return distances; }
+
+// -----------------------------------------------------------------------
+
+cv::Point Navigation_Field::get_goal() const { return goal; }
+
+// -----------------------------------------------------------------------
+
+int Navigation_Field::get_width() const { return width; }
+
+// -----------------------------------------------------------------------
+
+int Navigation_Field::get_height() const { return height; }
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,125 @@
+#ifndef NAVIGATION_FIELD_H
+#define NAVIGATION_FIELD_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+
+#include <iostream>
+#include <vector>
+#include <climits>
+
+using namespace std;
+using namespace cv;
+
+class Thread_Pool;
+
+class Navigation_Field
+{
+    /*************************************************************
+     *  Navigation function towards one goal: the cost to the goal
+     *  and the next step of every free pixel, from a single search
+     *  that starts at the goal.
+     *
+     *  When many robots or experiment samples share a goal, every
+     *  start then only follows its steps downhill to the goal, in
+     *  time proportional to the path length, instead of running
+     *  A_Star again.
+     *
+     *  The search is a bucket queue wavefront ( Dial's algorithm )
+     *  over the same 8-connected grid and step costs as A_Star. All
+     *  pixels of one bucket are final, so a large bucket is spread
+     *  over the threads, which lower the cost of the neighbors with
+     *  an atomic minimum. The steps are chosen afterwards from the
+     *  final costs, first neighbor in A_Star order, so the field is
+     *  the same with any number of threads.
+     ************************************************************/
+    public:
+        static const int UNREACHABLE = INT_MAX;
+
+        Navigation_Field();
+
+        /**
+         * @brief Navigation_Field
+         * @param img => BGR image
+         * @param goal => Must be a free pixel
+         * @param floor_plan => Same as A_Star, true = black pixels are
+         *      blocked, false = everything but red roadmap pixels is blocked
+         * @param threads => 0 = one per core
+         */
+        Navigation_Field( const cv::Mat &img,
+                          const cv::Point &goal,
+                          const bool floor_plan = true,
+                          const int threads = 0 );
+
+        /**
+         * @brief build -> Run the wavefront from the goal
+         * @param img
+         * @param goal
+         * @param floor_plan
+         * @param threads
+         */
+        void build( const cv::Mat &img,
+                    const cv::Point &goal,
+                    const bool floor_plan = true,
+                    const int threads = 0 );
+
+        /**
+         * @brief build -> As above on the threads of a pool, for callers
+         *      that build many fields
+         */
+        void build( const cv::Mat &img,
+                    const cv::Point &goal,
+                    const bool floor_plan,
+                    Thread_Pool &pool );
+
+        /**
+         * @brief find_path -> Follow the steps from start to the goal
+         * @param start
+         * @param path => Cleared and filled with the path, start excluded
+         *      and goal included ( same as A_Star::get_path ). Left empty
+         *      if the goal is unreachable.
+         * @return true if a path was found
+         */
+        bool find_path( const cv::Point &start, std::vector<cv::Point> &path ) const;
+
+        /**
+         * @brief distance
+         * @param p
+         * @return Cost from p to the goal in G_DIRECT/G_SKEW units,
+         *      UNREACHABLE if blocked or cut off from the goal
+         */
+        int distance( const cv::Point &p ) const;
+
+        /**
+         * @brief next_step
+         * @param p
+         * @return The neighbor to move to, p itself at the goal or if
+         *      the goal is unreachable
+         */
+        cv::Point next_step( const cv::Point &p ) const;
+
+        /**
+         * @brief draw -> Cost as color from blue ( near ) to red ( far ),
+         *      blocked pixels black, unreachable pixels gray
+         * @return
+         */
+        cv::Mat draw() const;
+
+        const std::vector<int> &get_distances() const;
+        cv::Point get_goal() const;
+        int get_width() const;
+        int get_height() const;
+
+        ~Navigation_Field();
+
+    private:
+        static const uchar NO_STEP = 255;
+
+        int width = 0, height = 0;
+        cv::Point goal;
+        std::vector<uchar> blocked;
+        std::vector<int> distances;     // y * width + x, UNREACHABLE = no path
+        std::vector<uchar> steps;       // Direction 0-7 in A_Star neighbor order, NO_STEP at the goal
+};
+
+#endif // NAVIGATION_FIELD_H
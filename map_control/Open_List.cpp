@@ -0,0 +1,346 @@
+#include "Open_List.h"
+
+// -----------------------------------------------------------------------
+
+Open_List *make_open_list( const int policy )
+{
+    switch ( policy )
+    {
+        case OPEN_LIST_LINEAR:
+            return new Linear_Open_List();
+        case OPEN_LIST_BUCKET:
+            return new Bucket_Open_List();
+        default:
+            return new Binary_Heap_Open_List();
+    }
+}
+
+// -----------------------------------------------------------------------
+// Linear open list
+// -----------------------------------------------------------------------
+
+void Linear_Open_List::reserve( const size_t n ) { (void)n; list.clear(); }
+
+// -----------------------------------------------------------------------
+
+void Linear_Open_List::push( const int id, const int f, const int h ) { list.push_back( { id, f, h } ); }
+
+// -----------------------------------------------------------------------
+
+void Linear_Open_List::decrease( const int id, const int f, const int h )
+{
+    for ( auto& e : list ) // Keeps its place in the list, as the linear scan did
+        if ( e.id == id )
+        {
+            e.f = f;
+            e.h = h;
+            return;
+        }
+}
+
+// -----------------------------------------------------------------------
+
+int Linear_Open_List::pop()
+{
+    size_t best = 0; // Default value
+    for (size_t i = 0; i < list.size(); i++)
+    {
+        if ( list[i].f <= list[best].f ) // Find a better choice
+            best = i;
+    }
+    int id = list[best].id;
+    list.erase( list.begin() + best );
+    return id;
+}
+
+// -----------------------------------------------------------------------
+
+bool Linear_Open_List::empty() const { return list.empty(); }
+
+// -----------------------------------------------------------------------
+
+size_t Linear_Open_List::size() const { return list.size(); }
+
+// -----------------------------------------------------------------------
+
+void Linear_Open_List::clear() { list.clear(); }
+
+// -----------------------------------------------------------------------
+// Binary heap open list
+// -----------------------------------------------------------------------
+
+static long long heap_key( const int f, const int h )
+{
+    return ( (long long)f << 32 ) | h; // Ties => closest to the goal first
+}
+
+// -----------------------------------------------------------------------
+
+void Binary_Heap_Open_List::reserve( const size_t n ) { heap.reserve( n ); }
+
+// -----------------------------------------------------------------------
+
+void Binary_Heap_Open_List::push( const int id, const int f, const int h ) { heap.push( id, heap_key( f, h ) ); }
+
+// -----------------------------------------------------------------------
+
+void Binary_Heap_Open_List::decrease( const int id, const int f, const int h ) { heap.push( id, heap_key( f, h ) ); }
+
+// -----------------------------------------------------------------------
+
+int Binary_Heap_Open_List::pop() { return heap.pop(); }
+
+// -----------------------------------------------------------------------
+
+bool Binary_Heap_Open_List::empty() const { return heap.empty(); }
+
+// -----------------------------------------------------------------------
+
+size_t Binary_Heap_Open_List::size() const { return heap.size(); }
+
+// -----------------------------------------------------------------------
+
+void Binary_Heap_Open_List::clear() { heap.clear(); }
+
+// -----------------------------------------------------------------------
+// Bucket open list
+// -----------------------------------------------------------------------
+
+void Bucket_Open_List::reserve( const size_t n )
+{
+    clear();
+    bucket_of.resize( n );
+    slot.assign( n, -1 );
+}
+
+// -----------------------------------------------------------------------
+
+void Bucket_Open_List::push( const int id, const int f, const int h )
+{
+    (void)h;
+    size_t key = (size_t)f;
+    if ( key >= buckets.size() )
+        buckets.resize( key + 1 );
+
+    bucket_of[id] = (int)key;
+    slot[id] = (int)buckets[key].size();
+    buckets[key].push_back( id );
+
+    if ( count == 0 || key < cursor )
+        cursor = key;
+    if ( key > highest )
+        highest = key;
+    count++;
+}
+
+// -----------------------------------------------------------------------
+
+void Bucket_Open_List::remove( const int id )
+{
+    // Swap with the last cell of the bucket, O(1)
+    std::vector<int> &bucket = buckets[bucket_of[id]];
+    int last = bucket.back();
+    bucket[slot[id]] = last;
+    slot[last] = slot[id];
+    bucket.pop_back();
+    slot[id] = -1;
+    count--;
+}
+
+// -----------------------------------------------------------------------
+
+void Bucket_Open_List::decrease( const int id, const int f, const int h )
+{
+    remove( id );
+    push( id, f, h );
+}
+
+// -----------------------------------------------------------------------
+
+int Bucket_Open_List::pop()
+{
+    while ( buckets[cursor].empty() )
+        cursor++;
+
+    int id = buckets[cursor].back(); // Newest cell first, as the linear scan did
+    remove( id );
+    return id;
+}
+
+// -----------------------------------------------------------------------
+
+bool Bucket_Open_List::empty() const { return count == 0; }
+
+// -----------------------------------------------------------------------
+
+size_t Bucket_Open_List::size() const { return count; }
+
+// -----------------------------------------------------------------------
+
+void Bucket_Open_List::clear()
+{
+    for (size_t i = 0; i < buckets.size() && i <= highest; i++)
+    {
+        for ( auto& id : buckets[i] )
+            slot[id] = -1;
+        buckets[i].clear();
+    }
+    cursor = highest = count = 0;
+}
+
+// -----------------------------------------------------------------------
+// Index heap
+// -----------------------------------------------------------------------
+
+Index_Heap::Index_Heap() {}
+
+// -----------------------------------------------------------------------
+
+void Index_Heap::reserve( const size_t n )
+{
+    clear();
+    position.assign( n, -1 );
+    heap.reserve( n );
+    keys.reserve( n );
+}
+
+// -----------------------------------------------------------------------
+
+void Index_Heap::place( const int id, const long long key, const size_t i )
+{
+    heap[i] = id;
+    keys[i] = key;
+    position[id] = (int)i;
+}
+
+// -----------------------------------------------------------------------
+
+void Index_Heap::sift_up( size_t i )
+{
+    int id = heap[i];
+    long long key = keys[i];
+    while ( i > 0 )
+    {
+        size_t parent = ( i - 1 ) / 2;
+        if ( !( key < keys[parent] ) )
+            break;
+        place( heap[parent], keys[parent], i );
+        i = parent;
+    }
+    place( id, key, i );
+}
+
+// -----------------------------------------------------------------------
+
+void Index_Heap::sift_down( size_t i )
+{
+    int id = heap[i];
+    long long key = keys[i];
+    const size_t n = heap.size();
+    while ( true )
+    {
+        size_t child = 2 * i + 1;
+        if ( child >= n )
+            break;
+        if ( child + 1 < n && keys[child+1] < keys[child] )
+            child++;
+        if ( !( keys[child] < key ) )
+            break;
+        place( heap[child], keys[child], i );
+        i = child;
+    }
+    place( id, key, i );
+}
+
+// -----------------------------------------------------------------------
+
+void Index_Heap::push( const int id, const long long key )
+{
+    int i = position[id];
+    if ( i < 0 )
+    {
+        heap.push_back( id );
+        keys.push_back( key );
+        sift_up( heap.size() - 1 );
+    }
+    else if ( key < keys[i] )
+    {
+        keys[i] = key;
+        sift_up( i );
+    }
+    else
+    {
+        keys[i] = key;
+        sift_down( i );
+    }
+}
+
+// -----------------------------------------------------------------------
+
+int Index_Heap::pop()
+{
+    int id = heap.front();
+    remove( id );
+    return id;
+}
+
+// -----------------------------------------------------------------------
+
+void Index_Heap::remove( const int id )
+{
+    int i = position[id];
+    if ( i < 0 )
+        return;
+
+    position[id] = -1;
+    int last = heap.back();
+    long long last_key = keys.back();
+    heap.pop_back();
+    keys.pop_back();
+    if ( (size_t)i == heap.size() )
+        return;
+
+    heap[i] = last;
+    keys[i] = last_key;
+    position[last] = i;
+    if ( i > 0 && last_key < keys[( i - 1 ) / 2] )
+        sift_up( i );
+    else
+        sift_down( i );
+}
+
+// -----------------------------------------------------------------------
+
+int Index_Heap::top() const { return heap.front(); }
+
+// -----------------------------------------------------------------------
+
+long long Index_Heap::top_key() const { return keys.front(); }
+
+// -----------------------------------------------------------------------
+
+long long Index_Heap::key_of( const int id ) const { return keys[position[id]]; }
+
+// -----------------------------------------------------------------------
+
+bool Index_Heap::contains( const int id ) const { return position[id] >= 0; }
+
+// -----------------------------------------------------------------------
+
+bool Index_Heap::empty() const { return heap.empty(); }
+
+// -----------------------------------------------------------------------
+
+size_t Index_Heap::size() const { return heap.size(); }
+
+// -----------------------------------------------------------------------
+
+void Index_Heap::clear()
+{
+    for ( auto& id : heap )
+        position[id] = -1;
+    heap.clear();
+    keys.clear();
+}
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,206 @@
+#ifndef OPEN_LIST_H
+#define OPEN_LIST_H
+
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+using namespace std;
+
+/***************************************
+ * Constants
+ ***************************************/
+
+const int OPEN_LIST_LINEAR = 0;        // Linear scan of a vector (original)
+const int OPEN_LIST_BINARY_HEAP = 1;   // Indexed binary heap with decrease-key
+const int OPEN_LIST_BUCKET = 2;        // Dial bucket queue over integer f values
+
+class Open_List
+{
+    /*************************************************************
+     *  Priority queue of cell indices ordered by f = g + h, ties
+     *  broken on h where the policy supports it.
+     *
+     *  A_Star keeps g, parent and the closed flag in its own flat
+     *  arrays, the list only holds ( index, f, h ). The lists know
+     *  where every open cell is, so decrease() moves the entry of a
+     *  cell whose g got lower and every cell is in the list once.
+     ************************************************************/
+    public:
+        virtual ~Open_List() {}
+
+        /**
+         * @brief reserve -> Make room for cell indices in the range [0, n),
+         *      empties the list
+         * @param n
+         */
+        virtual void reserve( const size_t n ) = 0;
+
+        /**
+         * @brief push -> Insert a cell which is not in the list
+         * @param id
+         * @param f
+         * @param h
+         */
+        virtual void push( const int id, const int f, const int h ) = 0;
+
+        /**
+         * @brief decrease -> The f of a cell in the list got smaller
+         * @param id
+         * @param f
+         * @param h
+         */
+        virtual void decrease( const int id, const int f, const int h ) = 0;
+
+        /**
+         * @brief pop -> Remove and return the cell with the lowest f
+         * @return
+         */
+        virtual int pop() = 0;
+
+        virtual bool empty() const = 0;
+        virtual size_t size() const = 0;
+        virtual void clear() = 0;
+};
+
+/**
+ * @brief make_open_list
+ * @param policy => OPEN_LIST_LINEAR, OPEN_LIST_BINARY_HEAP or OPEN_LIST_BUCKET
+ * @return
+ */
+Open_List *make_open_list( const int policy );
+
+// -----------------------------------------------------------------------
+
+struct Open_Entry
+{
+    int id, f, h;
+};
+
+// -----------------------------------------------------------------------
+
+class Index_Heap
+{
+    /*************************************************************
+     *  Binary heap over integer ids ( y * width + x ) with 64 bit
+     *  keys and decrease-key, for searches that keep their nodes
+     *  in flat arrays. All memory is allocated by reserve(), so
+     *  push/pop/decrease never allocate.
+     ************************************************************/
+    public:
+        Index_Heap();
+
+        /**
+         * @brief reserve -> Make room for ids in the range [0, n)
+         * @param n
+         */
+        void reserve( const size_t n );
+
+        /**
+         * @brief push -> Insert an id, or update its key if already in the heap
+         * @param id
+         * @param key
+         */
+        void push( const int id, const long long key );
+
+        /**
+         * @brief pop -> Remove and return the id with the lowest key
+         * @return
+         */
+        int pop();
+
+        /**
+         * @brief remove -> Remove an id if it is in the heap
+         * @param id
+         */
+        void remove( const int id );
+
+        int top() const;
+        long long top_key() const;
+        long long key_of( const int id ) const;
+        bool contains( const int id ) const;
+        bool empty() const;
+        size_t size() const;
+
+        /**
+         * @brief clear -> O(size), only the ids still in the heap are reset
+         */
+        void clear();
+
+    private:
+        std::vector<int> heap;
+        std::vector<long long> keys;    // Indexed by heap slot
+        std::vector<int> position;      // Indexed by id, -1 = not in heap
+
+        void place( const int id, const long long key, const size_t i );
+        void sift_up( size_t i );
+        void sift_down( size_t i );
+};
+
+// -----------------------------------------------------------------------
+
+class Linear_Open_List : public Open_List
+{
+    public:
+        void reserve( const size_t n );
+        void push( const int id, const int f, const int h );
+        void decrease( const int id, const int f, const int h );
+        int pop();
+        bool empty() const;
+        size_t size() const;
+        void clear();
+
+    private:
+        std::vector<Open_Entry> list;
+};
+
+// -----------------------------------------------------------------------
+
+class Binary_Heap_Open_List : public Open_List
+{
+    /*************************************************************
+     *  Index_Heap with the key ( f << 32 ) | h, so ties on f go to
+     *  the lowest h. Prepared_Roadmap files its nodes the same way.
+     ************************************************************/
+    public:
+        void reserve( const size_t n );
+        void push( const int id, const int f, const int h );
+        void decrease( const int id, const int f, const int h );
+        int pop();
+        bool empty() const;
+        size_t size() const;
+        void clear();
+
+    private:
+        Index_Heap heap;
+};
+
+// -----------------------------------------------------------------------
+
+class Bucket_Open_List : public Open_List
+{
+    /*************************************************************
+     *  Dial's bucket queue. G_DIRECT and G_SKEW are small integers
+     *  so f is an integer and can be used directly as bucket
+     *  index. The heuristic is not consistent, so the cursor may
+     *  have to move backwards when a cell with a lower f arrives.
+     ************************************************************/
+    public:
+        void reserve( const size_t n );
+        void push( const int id, const int f, const int h );
+        void decrease( const int id, const int f, const int h );
+        int pop();
+        bool empty() const;
+        size_t size() const;
+        void clear();
+
+    private:
+        std::vector< std::vector<int> > buckets;
+        std::vector<int> bucket_of;     // Indexed by id, bucket the cell is filed under
+        std::vector<int> slot;          // Indexed by id, place in its bucket, -1 = not in the list
+        size_t cursor = 0, highest = 0, count = 0;
+
+        void remove( const int id );
+};
+
+#endif // OPEN_LIST_H
@@ -0,0 +1,201 @@
+#include "Path_Cache.h"
+
+// Bookkeeping of an entry besides the path, list node and hash bucket included
+static const size_t ENTRY_OVERHEAD = 96;
+
+// -----------------------------------------------------------------------
+
+Path_Cache::Path_Cache( const size_t budget ) : budget( budget ) {}
+
+// -----------------------------------------------------------------------
+
+Path_Cache::~Path_Cache() {}
+
+// -----------------------------------------------------------------------
+
+uint64_t Path_Cache::make_key( const cv::Point &entry, const cv::Point &exit )
+{
+    // 16 bits per coordinate, maps are far smaller than 65536 pixels
+    return ( (uint64_t)(uint16_t)entry.x << 48 ) | ( (uint64_t)(uint16_t)entry.y << 32 ) |
+           ( (uint64_t)(uint16_t)exit.x << 16 ) | (uint64_t)(uint16_t)exit.y;
+}
+
+// -----------------------------------------------------------------------
+
+bool Path_Cache::check_roadmap( const Prepared_Roadmap &road_map )
+{
+    // Called with the lock held
+    if ( road_map.get_fingerprint() == fingerprint )
+        return true;
+
+    if ( !entries.empty() )
+        invalidations++;
+    drop_all();
+    fingerprint = road_map.get_fingerprint();
+    return false;
+}
+
+// -----------------------------------------------------------------------
+
+bool Path_Cache::find_path( const Prepared_Roadmap &road_map,
+                            const cv::Point &entry,
+                            const cv::Point &exit,
+                            std::vector<cv::Point> &path,
+                            Search_Workspace &workspace )
+{
+    uint64_t key = make_key( entry, exit );
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        check_roadmap( road_map );
+
+        auto it = index.find( key );
+        if ( it != index.end() )
+        {
+            hits++;
+            entries.splice( entries.begin(), entries, it->second ); // Move to the front
+            path = it->second->path;
+            return it->second->found;
+        }
+        misses++;
+    }
+
+    bool found = road_map.find_path( entry, exit, path, workspace );
+
+    std::lock_guard<std::mutex> lock( mutex );
+    if ( road_map.get_fingerprint() == fingerprint ) // Not cached if the roadmap changed meanwhile
+        insert( key, found, path );
+    return found;
+}
+
+// -----------------------------------------------------------------------
+
+bool Path_Cache::find_path( const Prepared_Roadmap &road_map,
+                            const cv::Point &entry,
+                            const cv::Point &exit,
+                            std::vector<cv::Point> &path )
+{
+    std::lock_guard<std::mutex> lock( default_mutex );
+    return find_path( road_map, entry, exit, path, default_workspace );
+}
+
+// -----------------------------------------------------------------------
+
+void Path_Cache::insert( const uint64_t key, const bool found, const std::vector<cv::Point> &path )
+{
+    if ( index.count( key ) ) // Another thread searched the same pair
+        return;
+
+    size_t bytes = ENTRY_OVERHEAD + path.size() * sizeof( cv::Point );
+    if ( bytes > budget )
+        return;
+
+    entries.push_front( { key, found, path, bytes } );
+    index[key] = entries.begin();
+    memory += bytes;
+    evict();
+}
+
+// -----------------------------------------------------------------------
+
+void Path_Cache::evict()
+{
+    while ( memory > budget && !entries.empty() )
+    {
+        memory -= entries.back().bytes;
+        index.erase( entries.back().key );
+        entries.pop_back();
+        evictions++;
+    }
+}
+
+// -----------------------------------------------------------------------
+
+void Path_Cache::drop_all()
+{
+    entries.clear();
+    index.clear();
+    memory = 0;
+}
+
+// -----------------------------------------------------------------------
+
+void Path_Cache::set_budget( const size_t budget )
+{
+    std::lock_guard<std::mutex> lock( mutex );
+    this->budget = budget;
+    evict();
+}
+
+// -----------------------------------------------------------------------
+
+size_t Path_Cache::get_budget() const
+{
+    std::lock_guard<std::mutex> lock( mutex );
+    return budget;
+}
+
+// -----------------------------------------------------------------------
+
+size_t Path_Cache::get_memory() const
+{
+    std::lock_guard<std::mutex> lock( mutex );
+    return memory;
+}
+
+// -----------------------------------------------------------------------
+
+size_t Path_Cache::size() const
+{
+    std::lock_guard<std::mutex> lock( mutex );
+    return entries.size();
+}
+
+// -----------------------------------------------------------------------
+
+long long Path_Cache::get_hits() const
+{
+    std::lock_guard<std::mutex> lock( mutex );
+    return hits;
+}
+
+// -----------------------------------------------------------------------
+
+long long Path_Cache::get_misses() const
+{
+    std::lock_guard<std::mutex> lock( mutex );
+    return misses;
+}
+
+// -----------------------------------------------------------------------
+
+long long Path_Cache::get_evictions() const
+{
+    std::lock_guard<std::mutex> lock( mutex );
+    return evictions;
+}
+
+// -----------------------------------------------------------------------
+
+long long Path_Cache::get_invalidations() const
+{
+    std::lock_guard<std::mutex> lock( mutex );
+    return invalidations;
+}
+
+// -----------------------------------------------------------------------
+
+void Path_Cache::reset_counters()
+{
+    std::lock_guard<std::mutex> lock( mutex );
+    hits = misses = evictions = invalidations = 0;
+}
+
+// -----------------------------------------------------------------------
+
+void Path_Cache::clear()
+{
+    std::lock_guard<std::mutex> lock( mutex );
+    drop_all();
+}
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,113 @@
+#ifndef PATH_CACHE_H
+#define PATH_CACHE_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+
+#include "Prepared_Roadmap.h"
+#include "Search_Workspace.h"
+
+using namespace std;
+using namespace cv;
+
+class Path_Cache
+{
+    /*************************************************************
+     *  Least recently used cache of roadmap paths, keyed by the
+     *  ( entry, exit ) pair the queries are snapped to with
+     *  A_Star::findWayToRoadMap. Many start and goal points snap to
+     *  the same roadmap pixels, so the same segment is searched
+     *  over and over without it.
+     *
+     *  Unreachable pairs are cached too. The entries are dropped
+     *  from the least recently used end when the memory budget is
+     *  exceeded, and all of them when a roadmap with another
+     *  fingerprint ( Prepared_Roadmap::get_fingerprint ) is searched.
+     *
+     *  All functions are thread-safe, a miss is searched outside
+     *  the lock with the workspace of the caller.
+     ************************************************************/
+    public:
+        /**
+         * @brief Path_Cache
+         * @param budget => Memory for the cached paths in bytes
+         */
+        Path_Cache( const size_t budget = 64 << 20 );
+
+        /**
+         * @brief find_path -> Cached Prepared_Roadmap::find_path
+         * @param road_map
+         * @param entry
+         * @param exit
+         * @param path => Same format as Prepared_Roadmap::find_path
+         * @param workspace => Used on a miss
+         * @return true if a path was found
+         */
+        bool find_path( const Prepared_Roadmap &road_map,
+                        const cv::Point &entry,
+                        const cv::Point &exit,
+                        std::vector<cv::Point> &path,
+                        Search_Workspace &workspace );
+
+        /**
+         * @brief find_path -> As above with the workspace of this object,
+         *      misses are searched one at a time
+         */
+        bool find_path( const Prepared_Roadmap &road_map,
+                        const cv::Point &entry,
+                        const cv::Point &exit,
+                        std::vector<cv::Point> &path );
+
+        /**
+         * @brief set_budget -> Evicts entries until the cache fits
+         * @param budget => Bytes
+         */
+        void set_budget( const size_t budget );
+
+        size_t get_budget() const;
+        size_t get_memory() const;     // Bytes used by the entries now
+        size_t size() const;           // Number of entries
+
+        long long get_hits() const;
+        long long get_misses() const;
+        long long get_evictions() const;
+        long long get_invalidations() const; // Times the roadmap changed
+
+        void reset_counters();
+        void clear();
+
+        ~Path_Cache();
+
+    private:
+        struct Cache_Entry
+        {
+            uint64_t key;
+            bool found;
+            std::vector<cv::Point> path;
+            size_t bytes;
+        };
+
+        size_t budget, memory = 0;
+        uint64_t fingerprint = 0;
+        long long hits = 0, misses = 0, evictions = 0, invalidations = 0;
+
+        std::list<Cache_Entry> entries; // Most recently used first
+        std::unordered_map<uint64_t, std::list<Cache_Entry>::iterator> index;
+        mutable std::mutex mutex;
+        std::mutex default_mutex;       // Guards default_workspace
+        Search_Workspace default_workspace;
+
+        static uint64_t make_key( const cv::Point &entry, const cv::Point &exit );
+        bool check_roadmap( const Prepared_Roadmap &road_map );
+        void insert( const uint64_t key, const bool found, const std::vector<cv::Point> &path );
+        void evict();
+        void drop_all();
+};
+
+#endif // PATH_CACHE_H
@@ -0,0 +1,319 @@
+#include "Prepared_Roadmap.h"
+#include "Grid_Map.h"
+
+#include <climits>
+
+// -----------------------------------------------------------------------
+
+Prepared_Roadmap::Prepared_Roadmap() {}
+
+// -----------------------------------------------------------------------
+
+Prepared_Roadmap::Prepared_Roadmap( const cv::Mat &road_map ) { prepare( road_map ); }
+
+// -----------------------------------------------------------------------
+
+Prepared_Roadmap::~Prepared_Roadmap() {}
+
+// -----------------------------------------------------------------------
+
+void Prepared_Roadmap::prepare( const cv::Mat &road_map )
+{
+    width = road_map.cols;
+    height = road_map.rows;
+    size_t size = (size_t)width * height;
+
+    passable.assign( size, 0 );
+    for (int y = 0; y < height; y++)
+    {
+        const Vec3b *row = road_map.ptr<Vec3b>( y );
+        for (int x = 0; x < width; x++)
+            if ( row[x] == Vec3b(0,0,255) ) // If pixel red => roadmap
+                passable[ y * width + x ] = 1;
+    }
+
+    Fingerprint hash;
+    hash.add( width );
+    hash.add( height );
+    for ( auto& p : passable )
+        hash.add_byte( p );
+    fingerprint = hash.get();
+
+    default_workspace.resize( size );
+    default_backward_workspace.resize( size );
+}
+
+// -----------------------------------------------------------------------
+
+int Prepared_Roadmap::compute_h( const int id, const int goal ) const
+{
+    int dx = abs( id % width - goal % width );
+    int dy = abs( id / width - goal / width );
+
+    if ( ALLOW_VERTEX_PASSTHROUGH )
+        return max( dx, dy ) * G_SKEW;
+    else
+        return ( dx + dy ) * G_DIRECT;
+}
+
+// -----------------------------------------------------------------------
+
+int Prepared_Roadmap::compute_g( const int id1, const int id2 ) const
+{
+    int dx = abs( id1 % width - id2 % width );
+    int dy = abs( id1 / width - id2 / width );
+
+    if ( dx > dy )
+        return G_SKEW * dy + G_DIRECT * ( dx - dy );
+    else
+        return G_SKEW * dx + G_DIRECT * ( dy - dx );
+}
+
+// -----------------------------------------------------------------------
+
+bool Prepared_Roadmap::find_path( const cv::Point &start,
+                                  const cv::Point &goal,
+                                  std::vector<cv::Point> &path )
+{
+    return find_path( start, goal, path, default_workspace );
+}
+
+// -----------------------------------------------------------------------
+
+bool Prepared_Roadmap::find_path( const cv::Point &start,
+                                  const cv::Point &goal,
+                                  std::vector<cv::Point> &path,
+                                  Search_Workspace &workspace ) const
+{
+    path.clear();
+    if ( !inside( start ) || !inside( goal ) || start == goal )
+        return false;
+
+    // Same neighbor order as A_Star::neighbors => L, T, R, B, LT, RT, RB, LB
+    static const int dx[8] = { -1,  0, 1, 0, -1,  1, 1, -1 };
+    static const int dy[8] = {  0, -1, 0, 1, -1, -1, 1,  1 };
+
+    workspace.resize( passable.size() );
+    workspace.next_generation();
+    const unsigned int generation = workspace.generation;
+    std::vector<unsigned int> &seen = workspace.seen, &closed = workspace.closed;
+    std::vector<int> &g = workspace.g, &parent = workspace.parent;
+    Index_Heap &open_list = workspace.open_list;
+
+    const int s = start.y * width + start.x;
+    const int t = goal.y * width + goal.x;
+
+    seen[s] = generation;
+    g[s] = 0;
+    parent[s] = -1;
+    open_list.clear();
+    open_list.push( s, 0 );   // The start node keeps h = 0 like in A_Star
+
+    bool found = false;
+    while ( !open_list.empty() )
+    {
+        int id = open_list.pop();
+        closed[id] = generation;
+
+        if ( id == t )
+        {
+            found = true;
+            break;
+        }
+
+        int x = id % width, y = id / width;
+        for (int k = 0; k < 8; k++)
+        {
+            int nx = x + dx[k], ny = y + dy[k];
+            if ( nx < 0 || ny < 0 || nx >= width || ny >= height )
+                continue;
+
+            int n = ny * width + nx;
+            if ( closed[n] == generation ||
+                 ( !passable[n] && n != s && n != t ) )
+                continue;
+
+            int new_g = g[id] + compute_g( n, id );
+            if ( seen[n] != generation || new_g < g[n] )
+            {
+                seen[n] = generation;
+                g[n] = new_g;
+                parent[n] = id;
+
+                // Sort on f, ties => lowest h, same order as Binary_Heap_Open_List
+                long long h = compute_h( n, t );
+                open_list.push( n, ( ( new_g + h ) << 32 ) | h );
+            }
+        }
+    }
+
+    if ( !found )
+        return false;
+
+    // Going back through parent, the start node is not part of the path
+    size_t length = 0;
+    for (int id = t; parent[id] != -1; id = parent[id])
+        length++;
+
+    path.resize( length );
+    for (int id = t; parent[id] != -1; id = parent[id])
+        path[--length] = Point( id % width, id / width );
+
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+bool Prepared_Roadmap::find_path_bidirectional( const cv::Point &start,
+                                                const cv::Point &goal,
+                                                std::vector<cv::Point> &path )
+{
+    return find_path_bidirectional( start, goal, path, default_workspace, default_backward_workspace );
+}
+
+// -----------------------------------------------------------------------
+
+bool Prepared_Roadmap::find_path_bidirectional( const cv::Point &start,
+                                                const cv::Point &goal,
+                                                std::vector<cv::Point> &path,
+                                                Search_Workspace &forward,
+                                                Search_Workspace &backward ) const
+{
+    path.clear();
+    if ( !inside( start ) || !inside( goal ) || start == goal )
+        return false;
+
+    static const int dx[8] = { -1,  0, 1, 0, -1,  1, 1, -1 };
+    static const int dy[8] = {  0, -1, 0, 1, -1, -1, 1,  1 };
+
+    const int s = start.y * width + start.x;
+    const int t = goal.y * width + goal.x;
+
+    Search_Workspace *side[2] = { &forward, &backward };
+    const int target[2] = { t, s };     // What each frontier is heading for
+    for (int d = 0; d < 2; d++)
+    {
+        Search_Workspace &w = *side[d];
+        w.resize( passable.size() );
+        w.next_generation();
+        w.open_list.clear();
+
+        int root = target[1-d];
+        w.seen[root] = w.generation;
+        w.g[root] = 0;
+        w.parent[root] = -1;
+        long long h = compute_g( root, target[d] );
+        w.open_list.push( root, ( h << 32 ) | h );
+    }
+
+    long long best = LLONG_MAX;     // Cost of the best path through a meeting node
+    int meeting = -1;
+
+    while ( !forward.open_list.empty() && !backward.open_list.empty() )
+    {
+        // Every path cheaper than best still has to pass an open node of
+        // each frontier, so once one frontier's lowest f reaches best it is done
+        if ( ( forward.open_list.top_key() >> 32 ) >= best ||
+             ( backward.open_list.top_key() >> 32 ) >= best )
+            break;
+
+        // Expand the smaller frontier
+        int d = ( forward.open_list.size() <= backward.open_list.size() ) ? 0 : 1;
+        Search_Workspace &w = *side[d];
+        Search_Workspace &other = *side[1-d];
+
+        int id = w.open_list.pop();
+        w.closed[id] = w.generation;
+
+        int x = id % width, y = id / width;
+        for (int k = 0; k < 8; k++)
+        {
+            int nx = x + dx[k], ny = y + dy[k];
+            if ( nx < 0 || ny < 0 || nx >= width || ny >= height )
+                continue;
+
+            int n = ny * width + nx;
+            if ( w.closed[n] == w.generation ||
+                 ( !passable[n] && n != s && n != t ) )
+                continue;
+
+            int new_g = w.g[id] + compute_g( n, id );
+            if ( w.seen[n] != w.generation || new_g < w.g[n] )
+            {
+                w.seen[n] = w.generation;
+                w.g[n] = new_g;
+                w.parent[n] = id;
+
+                long long h = compute_g( n, target[d] );
+                w.open_list.push( n, ( ( new_g + h ) << 32 ) | h );
+
+                if ( other.seen[n] == other.generation && new_g + other.g[n] < best )
+                {
+                    best = new_g + other.g[n];
+                    meeting = n;
+                }
+            }
+        }
+    }
+
+    if ( meeting < 0 ) // Havent found goal
+        return false;
+
+    // Start side from the meeting node back to the start, start excluded
+    size_t length = 0;
+    for (int id = meeting; forward.parent[id] != -1; id = forward.parent[id])
+        length++;
+
+    path.resize( length );
+    for (int id = meeting; forward.parent[id] != -1; id = forward.parent[id])
+        path[--length] = Point( id % width, id / width );
+
+    // Goal side from the meeting node to the goal, goal included
+    for (int id = backward.parent[meeting]; id != -1; id = backward.parent[id])
+        path.push_back( Point( id % width, id / width ) );
+
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+void Prepared_Roadmap::find_paths( const std::vector<std::pair<cv::Point, cv::Point>> &queries,
+                                   std::vector<std::vector<cv::Point>> &paths,
+                                   Thread_Pool &pool ) const
+{
+    paths.resize( queries.size() );
+    std::vector<Search_Workspace> workspaces( pool.get_thread_count() );
+
+    pool.parallel_for( queries.size(), [&]( size_t i, int thread )
+    {
+        find_path( queries[i].first, queries[i].second, paths[i], workspaces[thread] );
+    } );
+}
+
+// -----------------------------------------------------------------------
+
+bool Prepared_Roadmap::inside( const cv::Point &p ) const
+{
+    return p.x >= 0 && p.y >= 0 && p.x < width && p.y < height;
+}
+
+// -----------------------------------------------------------------------
+
+bool Prepared_Roadmap::is_roadmap( const cv::Point &p ) const
+{
+    return inside( p ) && passable[ p.y * width + p.x ] != 0;
+}
+
+// -----------------------------------------------------------------------
+
+int Prepared_Roadmap::get_width() const { return width; }
+
+// -----------------------------------------------------------------------
+
+int Prepared_Roadmap::get_height() const { return height; }
+
+// -----------------------------------------------------------------------
+
+uint64_t Prepared_Roadmap::get_fingerprint() const { return fingerprint; }
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,145 @@
+#ifndef PREPARED_ROADMAP_H
+#define PREPARED_ROADMAP_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+#include "opencv2/imgcodecs.hpp"
+#include "opencv2/highgui.hpp"
+#include "opencv2/imgproc.hpp"
+
+#include <iostream>
+#include <vector>
+#include <cstdint>
+
+#include "Search_Workspace.h"
+#include "Thread_Pool.h"
+
+using namespace std;
+using namespace cv;
+
+class Prepared_Roadmap
+{
+    /*************************************************************
+     *  A roadmap (Voronoi or boustrophedon decomposition) which is
+     *  classified once and then searched many times.
+     *
+     *  A_Star::get_path classifies every pixel of the roadmap again
+     *  and resets its node arrays on each call. Here the red pixels
+     *  are stored once as a flat passable mask, and the per query
+     *  state (g, parent, closed) is kept in a Search_Workspace and
+     *  invalidated by bumping a generation counter instead of
+     *  reallocating or clearing it.
+     *  After the first query a search makes no heap allocations as
+     *  long as the path buffer passed in has enough capacity.
+     *
+     *  The roadmap itself is never changed by a search, so the const
+     *  find_path and find_paths can be called from many threads at
+     *  once as long as every thread has its own workspace.
+     ************************************************************/
+    public:
+        Prepared_Roadmap();
+
+        /**
+         * @brief Prepared_Roadmap
+         * @param road_map => BGR image with the roadmap drawn as red pixels
+         */
+        Prepared_Roadmap( const cv::Mat &road_map );
+
+        /**
+         * @brief prepare -> Classify the roadmap pixels and size the workspace
+         * @param road_map
+         */
+        void prepare( const cv::Mat &road_map );
+
+        /**
+         * @brief find_path -> Same search and result as A_Star::get_path
+         * @param start
+         * @param goal
+         * @param path => Cleared and filled with the path, start excluded
+         *      and goal included. Left empty if the goal is unreachable.
+         * @return true if a path was found
+         */
+        bool find_path( const cv::Point &start,
+                        const cv::Point &goal,
+                        std::vector<cv::Point> &path,
+                        Search_Workspace &workspace ) const;
+
+        /**
+         * @brief find_path -> As above with the workspace of this object,
+         *      not thread-safe
+         */
+        bool find_path( const cv::Point &start,
+                        const cv::Point &goal,
+                        std::vector<cv::Point> &path );
+
+        /**
+         * @brief find_path_bidirectional -> Bidirectional A*, one frontier
+         *      grows from the start and one from the goal until they meet.
+         *      Stops as soon as the lowest f of either frontier is not
+         *      below the best meeting cost, so the path is optimal. The
+         *      octile distance is used as heuristic, not compute_h.
+         * @param start
+         * @param goal
+         * @param path => Same format as find_path
+         * @param forward => Workspace of the search from the start
+         * @param backward => Workspace of the search from the goal
+         * @return true if a path was found
+         */
+        bool find_path_bidirectional( const cv::Point &start,
+                                      const cv::Point &goal,
+                                      std::vector<cv::Point> &path,
+                                      Search_Workspace &forward,
+                                      Search_Workspace &backward ) const;
+
+        /**
+         * @brief find_path_bidirectional -> As above with the workspaces
+         *      of this object, not thread-safe
+         */
+        bool find_path_bidirectional( const cv::Point &start,
+                                      const cv::Point &goal,
+                                      std::vector<cv::Point> &path );
+
+        /**
+         * @brief find_paths -> Search all queries spread over the pool
+         * @param queries => ( start, goal ) pairs
+         * @param paths => paths[i] is the path of queries[i], empty if
+         *      none was found
+         * @param pool
+         */
+        void find_paths( const std::vector<std::pair<cv::Point, cv::Point>> &queries,
+                         std::vector<std::vector<cv::Point>> &paths,
+                         Thread_Pool &pool ) const;
+
+        /**
+         * @brief is_roadmap
+         * @param p
+         * @return true if p is a red roadmap pixel
+         */
+        bool is_roadmap( const cv::Point &p ) const;
+
+        int get_width() const;
+        int get_height() const;
+
+        /**
+         * @brief get_fingerprint
+         * @return Hash of the size and the roadmap pixels, changes when
+         *      prepare() is called with a different roadmap
+         */
+        uint64_t get_fingerprint() const;
+
+        ~Prepared_Roadmap();
+
+    private:
+        int width = 0, height = 0;
+        std::vector<uchar> passable;
+        uint64_t fingerprint = 0;
+
+        Search_Workspace default_workspace; // Used by the single threaded find_path
+        Search_Workspace default_backward_workspace;
+
+        int compute_h( const int id, const int goal ) const;
+        int compute_g( const int id1, const int id2 ) const;
+        bool inside( const cv::Point &p ) const;
+};
+
+#endif // PREPARED_ROADMAP_H
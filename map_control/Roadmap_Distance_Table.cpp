@@ -0,0 +1,316 @@
+#include "Roadmap_Distance_Table.h"
+#include "Grid_Map.h"
+
+#include <climits>
+
+// -----------------------------------------------------------------------
+
+Roadmap_Distance_Table::Roadmap_Distance_Table() {}
+
+// -----------------------------------------------------------------------
+
+Roadmap_Distance_Table::Roadmap_Distance_Table( const Roadmap_Graph &graph, const int threads )
+{
+    build( graph, threads );
+}
+
+// -----------------------------------------------------------------------
+
+Roadmap_Distance_Table::~Roadmap_Distance_Table() {}
+
+// -----------------------------------------------------------------------
+
+void Roadmap_Distance_Table::build( const Roadmap_Graph &graph, const int threads )
+{
+    this->graph = &graph;
+    n = (int)graph.get_vertices().size();
+    fingerprint = graph.make_fingerprint();
+    cost.assign( (size_t)n * n, -1 );
+    steps.assign( (size_t)n * n, 0 );
+    next.assign( (size_t)n * n, -1 );
+
+    // One source vertex per task, every thread keeps its own search state
+    Thread_Pool pool( threads );
+    std::vector<Search_Workspace> workspaces( pool.get_thread_count() );
+    std::vector<std::vector<int>> hops( pool.get_thread_count() ), first( pool.get_thread_count() );
+
+    pool.parallel_for( n, [&]( size_t s, int thread )
+    {
+        Search_Workspace &workspace = workspaces[thread];
+        workspace.resize( n );
+        hops[thread].resize( n );
+        first[thread].resize( n );
+        dijkstra( (int)s, workspace.open_list, workspace.g, hops[thread], first[thread] );
+    } );
+}
+
+// -----------------------------------------------------------------------
+
+void Roadmap_Distance_Table::dijkstra( const int source,
+                                       Index_Heap &open_list,
+                                       std::vector<int> &g,
+                                       std::vector<int> &hops,
+                                       std::vector<int> &first )
+{
+    const std::vector<Graph_Vertex> &vertices = graph->get_vertices();
+    const std::vector<Graph_Edge> &edges = graph->get_edges();
+
+    std::fill( g.begin(), g.end(), INT_MAX );
+    open_list.clear();
+    g[source] = 0;
+    hops[source] = 0;
+    first[source] = -1;
+    open_list.push( source, 0 );
+
+    while ( !open_list.empty() )
+    {
+        int u = open_list.pop();
+
+        // Only this thread writes the row of the source
+        size_t i = (size_t)source * n + u;
+        cost[i] = g[u];
+        steps[i] = hops[u];
+        next[i] = first[u];
+
+        for ( auto& id : vertices[u].edges )
+        {
+            const Graph_Edge &e = edges[id];
+            int w = ( e.from == u ) ? e.to : e.from;
+            int new_g = g[u] + e.cost();
+            if ( new_g < g[w] )
+            {
+                g[w] = new_g;
+                hops[w] = hops[u] + (int)e.pixels.size();
+                first[w] = ( u == source ) ? id : first[u];
+                open_list.push( w, new_g );
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+
+bool Roadmap_Distance_Table::save( const std::string &file ) const
+{
+    ofstream out( file, ios::binary );
+    if ( !out )
+        return false;
+
+    write_header( out, "RDT2", fingerprint );
+    write_binary( out, n );
+    write_binary( out, cost );
+    write_binary( out, steps );
+    write_binary( out, next );
+    return (bool)out;
+}
+
+// -----------------------------------------------------------------------
+
+bool Roadmap_Distance_Table::load( const std::string &file, const Roadmap_Graph &graph )
+{
+    unsigned long long graph_fingerprint = graph.make_fingerprint();
+    ifstream in( file, ios::binary );
+    if ( !in || !read_header( in, "RDT2", graph_fingerprint ) )
+        return false; // Made from another roadmap
+
+    int file_n = 0;
+    read_binary( in, file_n );
+    if ( !in || file_n != (int)graph.get_vertices().size() )
+        return false;
+
+    size_t size = (size_t)file_n * file_n;
+    std::vector<int> file_cost( size ), file_steps( size ), file_next( size );
+    read_binary( in, file_cost );
+    read_binary( in, file_steps );
+    read_binary( in, file_next );
+    if ( !in )
+        return false;
+
+    this->graph = &graph;
+    n = file_n;
+    fingerprint = graph_fingerprint;
+    cost.swap( file_cost );
+    steps.swap( file_steps );
+    next.swap( file_next );
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+int Roadmap_Distance_Table::vertex_cost( const int a, const int b ) const { return cost[ (size_t)a * n + b ]; }
+
+// -----------------------------------------------------------------------
+
+int Roadmap_Distance_Table::vertex_steps( const int a, const int b ) const { return steps[ (size_t)a * n + b ]; }
+
+// -----------------------------------------------------------------------
+
+int Roadmap_Distance_Table::next_edge( const int a, const int b ) const { return next[ (size_t)a * n + b ]; }
+
+// -----------------------------------------------------------------------
+
+int Roadmap_Distance_Table::get_vertex_count() const { return n; }
+
+// -----------------------------------------------------------------------
+
+bool Roadmap_Distance_Table::best_route( const cv::Point &start, const cv::Point &goal,
+                                         int &a, int &a_pos, int &b, int &b_pos,
+                                         int &best_cost, int &best_steps, bool &direct ) const
+{
+    int sv, se, si, gv, ge, gi;
+    if ( graph == 0 || start == goal ||
+         !graph->locate( start, sv, se, si ) ||
+         !graph->locate( goal, gv, ge, gi ) )
+        return false;
+
+    const std::vector<Graph_Edge> &edges = graph->get_edges();
+
+    // Up to two ways onto the graph at each end => ( vertex, cost, steps, chain position )
+    int s_vertex[2], s_cost[2], s_steps[2], s_pos[2], s_count = 0;
+    int g_vertex[2], g_cost[2], g_steps[2], g_pos[2], g_count = 0;
+
+    if ( sv >= 0 )
+    {
+        s_vertex[0] = sv; s_cost[0] = 0; s_steps[0] = 0; s_pos[0] = 0;
+        s_count = 1;
+    }
+    else
+    {
+        const Graph_Edge &e = edges[se];
+        int end = (int)e.pixels.size() - 1;
+        s_vertex[0] = e.from; s_cost[0] = graph->chain_cost( e, si ); s_steps[0] = si + 1; s_pos[0] = -1;
+        s_vertex[1] = e.to; s_cost[1] = e.cost() - s_cost[0]; s_steps[1] = end - si; s_pos[1] = end;
+        s_count = 2;
+    }
+
+    if ( gv >= 0 )
+    {
+        g_vertex[0] = gv; g_cost[0] = 0; g_steps[0] = 0; g_pos[0] = 0;
+        g_count = 1;
+    }
+    else
+    {
+        const Graph_Edge &e = edges[ge];
+        int end = (int)e.pixels.size() - 1;
+        g_vertex[0] = e.from; g_cost[0] = graph->chain_cost( e, gi ); g_steps[0] = gi + 1; g_pos[0] = -1;
+        g_vertex[1] = e.to; g_cost[1] = e.cost() - g_cost[0]; g_steps[1] = end - gi; g_pos[1] = end;
+        g_count = 2;
+    }
+
+    best_cost = INT_MAX;
+    direct = false;
+    if ( sv < 0 && gv < 0 && se == ge ) // Straight along the shared edge
+    {
+        best_cost = abs( graph->chain_cost( edges[se], si ) - graph->chain_cost( edges[se], gi ) );
+        best_steps = abs( si - gi );
+        direct = true;
+    }
+
+    for (int i = 0; i < s_count; i++)
+        for (int j = 0; j < g_count; j++)
+        {
+            int c = vertex_cost( s_vertex[i], g_vertex[j] );
+            if ( c < 0 )
+                continue;
+
+            c += s_cost[i] + g_cost[j];
+            if ( c < best_cost )
+            {
+                best_cost = c;
+                best_steps = s_steps[i] + vertex_steps( s_vertex[i], g_vertex[j] ) + g_steps[j];
+                a = s_vertex[i]; a_pos = s_pos[i];
+                b = g_vertex[j]; b_pos = g_pos[j];
+                direct = false;
+            }
+        }
+
+    return best_cost != INT_MAX;
+}
+
+// -----------------------------------------------------------------------
+
+bool Roadmap_Distance_Table::path_length( const cv::Point &start,
+                                          const cv::Point &goal,
+                                          int &cost,
+                                          int &steps ) const
+{
+    Point s, t;
+    if ( graph == 0 || !graph->anchors( start, goal, s, t ) )
+        return false;
+
+    int a, a_pos, b, b_pos, end_steps;
+    bool direct;
+    cost = steps = 0;
+    if ( s != t && !best_route( s, t, a, a_pos, b, b_pos, cost, steps, direct ) )
+        return false;
+
+    cost += graph->end_cost( start, goal, end_steps );
+    steps += end_steps;
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+bool Roadmap_Distance_Table::find_path( const cv::Point &start,
+                                        const cv::Point &goal,
+                                        std::vector<cv::Point> &path ) const
+{
+    path.clear();
+
+    Point s, t;
+    if ( graph == 0 || !graph->anchors( start, goal, s, t ) ||
+         ( s != t && !find_kept_path( s, t, path ) ) )
+        return false;
+
+    graph->attach_ends( start, goal, path );
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+bool Roadmap_Distance_Table::find_kept_path( const cv::Point &start,
+                                             const cv::Point &goal,
+                                             std::vector<cv::Point> &path ) const
+{
+    int a, a_pos, b, b_pos, best_cost, best_steps;
+    bool direct;
+    if ( !best_route( start, goal, a, a_pos, b, b_pos, best_cost, best_steps, direct ) )
+        return false;
+
+    int sv, se, si, gv, ge, gi;
+    graph->locate( start, sv, se, si );
+    graph->locate( goal, gv, ge, gi );
+    const std::vector<Graph_Edge> &edges = graph->get_edges();
+
+    if ( direct )
+    {
+        graph->append_chain( edges[se], si, gi, path );
+        return true;
+    }
+
+    if ( sv < 0 ) // From the start pixel to the first vertex
+        graph->append_chain( edges[se], si, a_pos, path );
+
+    for (int v = a; v != b; )
+    {
+        const Graph_Edge &e = edges[ next_edge( v, b ) ];
+        int end = (int)e.pixels.size() - 1;
+        if ( e.from == v )
+        {
+            graph->append_chain( e, -1, end, path );
+            v = e.to;
+        }
+        else
+        {
+            graph->append_chain( e, end, -1, path );
+            v = e.from;
+        }
+    }
+
+    if ( gv < 0 ) // From the last vertex to the goal pixel
+        graph->append_chain( edges[ge], b_pos, gi, path );
+
+    return true;
+}
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,118 @@
+#ifndef ROADMAP_DISTANCE_TABLE_H
+#define ROADMAP_DISTANCE_TABLE_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Open_List.h"
+#include "Roadmap_Graph.h"
+
+using namespace std;
+using namespace cv;
+
+class Roadmap_Distance_Table
+{
+    /*************************************************************
+     *  All pairs shortest paths between the vertices of a
+     *  Roadmap_Graph.
+     *
+     *  One Dijkstra per vertex is run on all cores. For every pair
+     *  the table keeps the path cost, the path length in pixels and
+     *  the first edge to take ( next hop ), so a length query between
+     *  two roadmap pixels is a handful of lookups and a full path is
+     *  unrolled by following next hops.
+     *
+     *  The table can be saved next to the roadmap and loaded again,
+     *  a fingerprint of the graph makes sure it belongs to it.
+     ************************************************************/
+    public:
+        Roadmap_Distance_Table();
+
+        /**
+         * @brief Roadmap_Distance_Table
+         * @param graph => Must outlive the table
+         * @param threads => 0 = one per core
+         */
+        Roadmap_Distance_Table( const Roadmap_Graph &graph, const int threads = 0 );
+
+        /**
+         * @brief build -> Run one Dijkstra from every vertex
+         * @param graph => Must outlive the table
+         * @param threads => 0 = one per core
+         */
+        void build( const Roadmap_Graph &graph, const int threads = 0 );
+
+        /**
+         * @brief save -> Write the table to a binary file
+         * @param file => e.g. "voronoi_roadmap.png.dist"
+         * @return
+         */
+        bool save( const std::string &file ) const;
+
+        /**
+         * @brief load -> Read a table written by save()
+         * @param file
+         * @param graph => The graph the table was built from
+         * @return false if the file is missing or belongs to another graph
+         */
+        bool load( const std::string &file, const Roadmap_Graph &graph );
+
+        /**
+         * @brief path_length -> Shortest path between two roadmap pixels
+         * @param start
+         * @param goal
+         * @param cost => Cost in G_DIRECT/G_SKEW units
+         * @param steps => Number of pixels in the path ( start excluded )
+         * @return false if unreachable or not on the roadmap
+         */
+        bool path_length( const cv::Point &start,
+                          const cv::Point &goal,
+                          int &cost,
+                          int &steps ) const;
+
+        /**
+         * @brief find_path -> Same result format as A_Star::get_path
+         * @param start
+         * @param goal
+         * @param path
+         * @return
+         */
+        bool find_path( const cv::Point &start,
+                        const cv::Point &goal,
+                        std::vector<cv::Point> &path ) const;
+
+        int vertex_cost( const int a, const int b ) const;
+        int vertex_steps( const int a, const int b ) const;
+        int next_edge( const int a, const int b ) const;
+        int get_vertex_count() const;
+
+        ~Roadmap_Distance_Table();
+
+    private:
+        const Roadmap_Graph *graph = 0;
+        int n = 0;
+        unsigned long long fingerprint = 0;
+        std::vector<int> cost;      // n * n, -1 = unreachable
+        std::vector<int> steps;     // n * n
+        std::vector<int> next;      // n * n, first edge from a towards b
+
+        void dijkstra( const int source,
+                       Index_Heap &open_list,
+                       std::vector<int> &g,
+                       std::vector<int> &hops,
+                       std::vector<int> &first );
+
+        bool best_route( const cv::Point &start, const cv::Point &goal,
+                         int &a, int &a_pos, int &b, int &b_pos,
+                         int &best_cost, int &best_steps, bool &direct ) const;
+        bool find_kept_path( const cv::Point &start,
+                             const cv::Point &goal,
+                             std::vector<cv::Point> &path ) const;
+};
+
+#endif // ROADMAP_DISTANCE_TABLE_H
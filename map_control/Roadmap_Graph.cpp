@@ -0,0 +1,587 @@
+#include "Roadmap_Graph.h"
+#include "Grid_Map.h"
+
+#include <climits>
+
+/*
+ *  The red neighbors of a pixel packed into one byte, bit k = NEIGHBOR_DX[k], NEIGHBOR_DY[k].
+ *  corner[code] = 1 for a staircase corner of the thinning ( XX. over .XX ):
+ *  exactly two straight neighbors at a right angle, and all neighbors
+ *  touch each other without the pixel, so they stay connected when it is
+ *  dropped and the chain takes the diagonal step past it.
+ */
+struct Corner_Table
+{
+    uchar corner[256];
+
+    Corner_Table()
+    {
+        for (int code = 0; code < 256; code++)
+        {
+            int straight = ( code & 1 ) + ( ( code >> 1 ) & 1 ) + ( ( code >> 2 ) & 1 ) + ( ( code >> 3 ) & 1 );
+            bool right_angle = ( code & 5 ) != 5 && ( code & 10 ) != 10; // Not L and R, not T and B
+
+            // Grow from the first neighbor over touching neighbors
+            int reached = code & -code, last;
+            do
+            {
+                last = reached;
+                for (int i = 0; i < 8; i++)
+                    for (int j = 0; j < 8; j++)
+                        if ( ( ( reached >> i ) & 1 ) && ( ( code >> j ) & 1 ) &&
+                             abs( NEIGHBOR_DX[i] - NEIGHBOR_DX[j] ) <= 1 && abs( NEIGHBOR_DY[i] - NEIGHBOR_DY[j] ) <= 1 )
+                            reached |= 1 << j;
+            }
+            while ( reached != last );
+
+            corner[code] = ( straight == 2 && right_angle && reached == code );
+        }
+    }
+};
+
+static const Corner_Table CORNER_TABLE;
+
+// -----------------------------------------------------------------------
+
+Roadmap_Graph::Roadmap_Graph() {}
+
+// -----------------------------------------------------------------------
+
+Roadmap_Graph::Roadmap_Graph( const cv::Mat &road_map ) { build( road_map ); }
+
+// -----------------------------------------------------------------------
+
+Roadmap_Graph::~Roadmap_Graph() {}
+
+// -----------------------------------------------------------------------
+
+void Roadmap_Graph::build( const cv::Mat &road_map )
+{
+    width = road_map.cols;
+    height = road_map.rows;
+    size_t size = (size_t)width * height;
+
+    vertices.clear();
+    edges.clear();
+    vertex_of.assign( size, -1 );
+    edge_of.assign( size, -1 );
+    index_of.assign( size, -1 );
+    anchor_of.assign( size, -1 );
+
+    std::vector<uchar> red( size, 0 );
+    for (int y = 0; y < height; y++)
+    {
+        const Vec3b *row = road_map.ptr<Vec3b>( y );
+        for (int x = 0; x < width; x++)
+            if ( row[x] == Vec3b(0,0,255) ) // If pixel red => roadmap
+                red[ y * width + x ] = 1;
+    }
+
+    // Staircase corners are dropped in row order, so of two corners next to each other only the
+    // first goes. A dropped pixel hangs off a kept neighbor, which has to stay.
+    std::vector<uchar> anchored( size, 0 );
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+        {
+            int i = y * width + x;
+            if ( !red[i] )
+                continue;
+
+            anchor_of[i] = i;
+            int code = 0, anchor = -1;
+            for (int k = 0; k < 8; k++)
+            {
+                int nx = x + NEIGHBOR_DX[k], ny = y + NEIGHBOR_DY[k];
+                if ( nx >= 0 && ny >= 0 && nx < width && ny < height && red[ ny * width + nx ] )
+                {
+                    code |= 1 << k;
+                    if ( anchor < 0 ) // Straight neighbors first
+                        anchor = ny * width + nx;
+                }
+            }
+
+            if ( !anchored[i] && CORNER_TABLE.corner[code] )
+            {
+                red[i] = 0;
+                anchor_of[i] = anchor;
+                anchored[anchor] = 1;
+            }
+        }
+
+    // Endpoints and junctions
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+        {
+            if ( !red[ y * width + x ] )
+                continue;
+
+            int degree = 0;
+            for (int k = 0; k < 8; k++)
+            {
+                int nx = x + NEIGHBOR_DX[k], ny = y + NEIGHBOR_DY[k];
+                if ( nx >= 0 && ny >= 0 && nx < width && ny < height && red[ ny * width + nx ] )
+                    degree++;
+            }
+
+            if ( degree != 2 )
+            {
+                vertex_of[ y * width + x ] = (int)vertices.size();
+                Graph_Vertex v;
+                v.point = Point( x, y );
+                vertices.push_back( v );
+            }
+        }
+
+    size_t junctions = vertices.size();
+    for (size_t v = 0; v < junctions; v++)
+        trace( (int)v, red );
+
+    // Closed loops without any junction get an artificial vertex
+    for (size_t i = 0; i < size; i++)
+        if ( red[i] && vertex_of[i] < 0 && edge_of[i] < 0 )
+        {
+            vertex_of[i] = (int)vertices.size();
+            Graph_Vertex v;
+            v.point = Point( (int)( i % width ), (int)( i / width ) );
+            vertices.push_back( v );
+            trace( vertex_of[i], red );
+        }
+
+    default_workspace.resize( vertices.size() );
+}
+
+// -----------------------------------------------------------------------
+
+void Roadmap_Graph::trace( const int v, const std::vector<uchar> &red )
+{
+    const Point p = vertices[v].point;
+
+    for (int k = 0; k < 8; k++)
+    {
+        Point q( p.x + NEIGHBOR_DX[k], p.y + NEIGHBOR_DY[k] );
+        if ( q.x < 0 || q.y < 0 || q.x >= width || q.y >= height )
+            continue;
+
+        int qi = q.y * width + q.x;
+        if ( !red[qi] || edge_of[qi] >= 0 )
+            continue;
+
+        Graph_Edge edge;
+        edge.from = v;
+
+        if ( vertex_of[qi] >= 0 ) // Two neighboring vertices, add the edge once
+        {
+            if ( vertex_of[qi] < v )
+                continue;
+            edge.to = vertex_of[qi];
+            edge.pixels.push_back( q );
+            add_edge( edge );
+            continue;
+        }
+
+        // Walk along the pixels with exactly two neighbors until a vertex
+        int edge_id = (int)edges.size();
+        Point prev = p, cur = q;
+        while ( true )
+        {
+            int ci = cur.y * width + cur.x;
+            edge.pixels.push_back( cur );
+
+            if ( vertex_of[ci] >= 0 )
+            {
+                edge.to = vertex_of[ci];
+                break;
+            }
+
+            edge_of[ci] = edge_id;
+            index_of[ci] = (int)edge.pixels.size() - 1;
+
+            Point next = prev;
+            for (int j = 0; j < 8; j++)
+            {
+                Point n( cur.x + NEIGHBOR_DX[j], cur.y + NEIGHBOR_DY[j] );
+                if ( n.x < 0 || n.y < 0 || n.x >= width || n.y >= height || n == prev )
+                    continue;
+                if ( red[ n.y * width + n.x ] )
+                {
+                    next = n;
+                    break;
+                }
+            }
+            prev = cur;
+            cur = next;
+        }
+        add_edge( edge );
+    }
+}
+
+// -----------------------------------------------------------------------
+
+void Roadmap_Graph::add_edge( Graph_Edge &edge )
+{
+    Point prev = vertices[edge.from].point;
+    int cost = 0;
+    edge.length = 0;
+    edge.costs.resize( edge.pixels.size() );
+    for (size_t i = 0; i < edge.pixels.size(); i++)
+    {
+        int dx = abs( edge.pixels[i].x - prev.x ), dy = abs( edge.pixels[i].y - prev.y );
+        bool skew = ( dx + dy == 2 );
+        cost += skew ? G_SKEW : G_DIRECT;
+        edge.length += skew ? sqrt(2.0) : 1.0;
+        edge.costs[i] = cost;
+        prev = edge.pixels[i];
+    }
+
+    int id = (int)edges.size();
+    vertices[edge.from].edges.push_back( id );
+    if ( edge.to != edge.from )
+        vertices[edge.to].edges.push_back( id );
+    edges.push_back( edge );
+}
+
+// -----------------------------------------------------------------------
+
+int Roadmap_Graph::compute_h( const cv::Point &p1, const cv::Point &p2 ) const
+{
+    // Octile distance, never more than the cost of a pixel chain between the points
+    int dx = abs( p1.x - p2.x ), dy = abs( p1.y - p2.y );
+    return G_DIRECT * max( dx, dy ) + ( G_SKEW - G_DIRECT ) * min( dx, dy );
+}
+
+// -----------------------------------------------------------------------
+
+cv::Point Roadmap_Graph::chain_point( const Graph_Edge &edge, const int i ) const
+{
+    return ( i < 0 ) ? vertices[edge.from].point : edge.pixels[i];
+}
+
+// -----------------------------------------------------------------------
+
+int Roadmap_Graph::chain_cost( const Graph_Edge &edge, const int i ) const
+{
+    return ( i < 0 ) ? 0 : edge.costs[i];
+}
+
+// -----------------------------------------------------------------------
+
+void Roadmap_Graph::append_chain( const Graph_Edge &edge, int a, const int b,
+                                  std::vector<cv::Point> &path ) const
+{
+    // Chain positions go from -1 ( "from" vertex ) to size-1 ( "to" vertex ), a excluded
+    int step = ( b > a ) ? 1 : -1;
+    while ( a != b )
+    {
+        a += step;
+        path.push_back( chain_point( edge, a ) );
+    }
+}
+
+// -----------------------------------------------------------------------
+
+bool Roadmap_Graph::locate( const cv::Point &p, int &vertex, int &edge, int &index ) const
+{
+    vertex = edge = index = -1;
+    if ( p.x < 0 || p.y < 0 || p.x >= width || p.y >= height )
+        return false;
+
+    int i = p.y * width + p.x;
+    vertex = vertex_of[i];
+    if ( vertex < 0 )
+    {
+        edge = edge_of[i];
+        index = index_of[i];
+    }
+    return vertex >= 0 || edge >= 0;
+}
+
+// -----------------------------------------------------------------------
+
+cv::Point Roadmap_Graph::anchor( const cv::Point &p ) const
+{
+    if ( p.x < 0 || p.y < 0 || p.x >= width || p.y >= height || anchor_of[ p.y * width + p.x ] < 0 )
+        return Point( -1, -1 );
+    int i = anchor_of[ p.y * width + p.x ];
+    return Point( i % width, i / width );
+}
+
+// -----------------------------------------------------------------------
+
+bool Roadmap_Graph::anchors( const cv::Point &start, const cv::Point &goal,
+                             cv::Point &start_anchor, cv::Point &goal_anchor ) const
+{
+    start_anchor = anchor( start );
+    goal_anchor = anchor( goal );
+    return start != goal && start_anchor.x >= 0 && goal_anchor.x >= 0;
+}
+
+// -----------------------------------------------------------------------
+
+void Roadmap_Graph::attach_ends( const cv::Point &start, const cv::Point &goal,
+                                 std::vector<cv::Point> &path ) const
+{
+    Point s = anchor( start ), t = anchor( goal );
+    if ( s != start )
+        path.insert( path.begin(), s );
+    if ( t != goal )
+        path.push_back( goal );
+}
+
+// -----------------------------------------------------------------------
+
+int Roadmap_Graph::end_cost( const cv::Point &start, const cv::Point &goal, int &steps ) const
+{
+    Point ends[2][2] = { { start, anchor( start ) }, { goal, anchor( goal ) } };
+    int cost = 0;
+    steps = 0;
+    for ( auto& end : ends )
+        if ( end[0] != end[1] )
+        {
+            cost += ( end[0].x == end[1].x || end[0].y == end[1].y ) ? G_DIRECT : G_SKEW;
+            steps++;
+        }
+    return cost;
+}
+
+// -----------------------------------------------------------------------
+
+bool Roadmap_Graph::find_path( const cv::Point &start,
+                               const cv::Point &goal,
+                               std::vector<cv::Point> &path )
+{
+    return find_path( start, goal, path, default_workspace );
+}
+
+// -----------------------------------------------------------------------
+
+bool Roadmap_Graph::find_path( const cv::Point &start,
+                               const cv::Point &goal,
+                               std::vector<cv::Point> &path,
+                               Search_Workspace &workspace ) const
+{
+    path.clear();
+
+    Point s, t;
+    if ( !anchors( start, goal, s, t ) ||
+         ( s != t && !find_kept_path( s, t, path, workspace ) ) )
+        return false;
+
+    attach_ends( start, goal, path );
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+bool Roadmap_Graph::find_kept_path( const cv::Point &start,
+                                    const cv::Point &goal,
+                                    std::vector<cv::Point> &path,
+                                    Search_Workspace &workspace ) const
+{
+    int sv, se, si, gv, ge, gi;
+    if ( start == goal ||
+         !locate( start, sv, se, si ) ||
+         !locate( goal, gv, ge, gi ) )
+        return false;
+
+    workspace.resize( vertices.size() );
+    workspace.next_generation();
+    const unsigned int generation = workspace.generation;
+    std::vector<unsigned int> &seen = workspace.seen, &closed = workspace.closed;
+    std::vector<int> &g = workspace.g, &parent_edge = workspace.parent, &route = workspace.route;
+    Index_Heap &open_list = workspace.open_list;
+    open_list.clear();
+
+    // Seed with the start vertex, or both ends of the edge the start is on
+    auto seed = [&]( const int v, const int cost )
+    {
+        if ( seen[v] == generation && g[v] <= cost )
+            return;
+        seen[v] = generation;
+        g[v] = cost;
+        parent_edge[v] = -1;
+        long long h = compute_h( vertices[v].point, goal );
+        open_list.push( v, ( ( cost + h ) << 32 ) | h );
+    };
+
+    if ( sv >= 0 )
+        seed( sv, 0 );
+    else
+    {
+        const Graph_Edge &e = edges[se];
+        seed( e.from, chain_cost( e, si ) );
+        seed( e.to, e.cost() - chain_cost( e, si ) );
+    }
+
+    int best = INT_MAX, best_vertex = -1, best_side = 0;
+    if ( sv < 0 && gv < 0 && se == ge ) // Straight along the shared edge
+    {
+        best = abs( chain_cost( edges[se], si ) - chain_cost( edges[se], gi ) );
+        best_vertex = -2;
+    }
+
+    while ( !open_list.empty() )
+    {
+        if ( ( open_list.top_key() >> 32 ) >= best ) // Nothing left can beat best
+            break;
+
+        int u = open_list.pop();
+        closed[u] = generation;
+
+        if ( gv >= 0 )
+        {
+            if ( u == gv )
+            {
+                best = g[u];
+                best_vertex = u;
+                break;
+            }
+        }
+        else
+        {
+            const Graph_Edge &e = edges[ge];
+            if ( u == e.from && g[u] + chain_cost( e, gi ) < best )
+            {
+                best = g[u] + chain_cost( e, gi );
+                best_vertex = u;
+                best_side = -1;
+            }
+            if ( u == e.to && g[u] + e.cost() - chain_cost( e, gi ) < best )
+            {
+                best = g[u] + e.cost() - chain_cost( e, gi );
+                best_vertex = u;
+                best_side = (int)e.pixels.size() - 1;
+            }
+        }
+
+        for ( auto& id : vertices[u].edges )
+        {
+            const Graph_Edge &e = edges[id];
+            int w = ( e.from == u ) ? e.to : e.from;
+            if ( w == u || closed[w] == generation )
+                continue;
+
+            int new_g = g[u] + e.cost();
+            if ( seen[w] != generation || new_g < g[w] )
+            {
+                seen[w] = generation;
+                g[w] = new_g;
+                parent_edge[w] = id;
+                long long h = compute_h( vertices[w].point, goal );
+                open_list.push( w, ( ( new_g + h ) << 32 ) | h );
+            }
+        }
+    }
+
+    if ( best_vertex == -1 ) // Havent found goal
+        return false;
+
+    if ( best_vertex == -2 )
+    {
+        append_chain( edges[se], si, gi, path );
+        return true;
+    }
+
+    // Vertices from the goal side back to the seeded vertex
+    route.clear();
+    for (int v = best_vertex; ; )
+    {
+        route.push_back( v );
+        if ( parent_edge[v] < 0 )
+            break;
+        const Graph_Edge &e = edges[ parent_edge[v] ];
+        v = ( e.from == v ) ? e.to : e.from;
+    }
+    reverse( route.begin(), route.end() );
+
+    if ( sv < 0 ) // From the start pixel to the first vertex
+    {
+        const Graph_Edge &e = edges[se];
+        int end = (int)e.pixels.size() - 1;
+        bool from_side = ( route[0] == e.from );
+        if ( e.from == e.to )
+            from_side = ( chain_cost( e, si ) <= e.cost() - chain_cost( e, si ) );
+        append_chain( e, si, from_side ? -1 : end, path );
+    }
+
+    for (size_t i = 1; i < route.size(); i++)
+    {
+        const Graph_Edge &e = edges[ parent_edge[ route[i] ] ];
+        int end = (int)e.pixels.size() - 1;
+        if ( e.from == route[i-1] )
+            append_chain( e, -1, end, path );
+        else
+            append_chain( e, end, -1, path );
+    }
+
+    if ( gv < 0 ) // From the last vertex to the goal pixel
+        append_chain( edges[ge], best_side, gi, path );
+
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+void Roadmap_Graph::find_paths( const std::vector<std::pair<cv::Point, cv::Point>> &queries,
+                                std::vector<std::vector<cv::Point>> &paths,
+                                Thread_Pool &pool ) const
+{
+    paths.resize( queries.size() );
+    std::vector<Search_Workspace> workspaces( pool.get_thread_count() );
+
+    pool.parallel_for( queries.size(), [&]( size_t i, int thread )
+    {
+        find_path( queries[i].first, queries[i].second, paths[i], workspaces[thread] );
+    } );
+}
+
+// -----------------------------------------------------------------------
+
+const std::vector<Graph_Vertex> &Roadmap_Graph::get_vertices() const { return vertices; }
+
+// -----------------------------------------------------------------------
+
+const std::vector<Graph_Edge> &Roadmap_Graph::get_edges() const { return edges; }
+
+// -----------------------------------------------------------------------
+
+int Roadmap_Graph::get_width() const { return width; }
+
+// -----------------------------------------------------------------------
+
+int Roadmap_Graph::get_height() const { return height; }
+
+// -----------------------------------------------------------------------
+
+unsigned long long Roadmap_Graph::make_fingerprint() const
+{
+    Fingerprint hash;
+    hash.add( width );
+    hash.add( height );
+    for ( auto& v : vertices )
+    {
+        hash.add( v.point.x );
+        hash.add( v.point.y );
+    }
+    for ( auto& e : edges )
+    {
+        hash.add( e.from );
+        hash.add( e.to );
+        hash.add( e.cost() );
+    }
+    return hash.get();
+}
+
+// -----------------------------------------------------------------------
+
+cv::Mat Roadmap_Graph::draw( const cv::Mat &img ) const
+{
+    Mat result = img.clone();
+    for ( auto& e : edges )
+        for ( auto& p : e.pixels )
+            result.at<Vec3b>( p ) = Vec3b(0,0,255);
+    for ( auto& v : vertices )
+        result.at<Vec3b>( v.point ) = Vec3b(255,0,0);
+    return result;
+}
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,228 @@
+#ifndef ROADMAP_GRAPH_H
+#define ROADMAP_GRAPH_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+#include "opencv2/imgcodecs.hpp"
+#include "opencv2/highgui.hpp"
+#include "opencv2/imgproc.hpp"
+
+#include <iostream>
+#include <vector>
+
+#include "Search_Workspace.h"
+#include "Thread_Pool.h"
+
+using namespace std;
+using namespace cv;
+
+struct Graph_Vertex
+{
+    Point point;
+    vector<int> edges;      // Ids of the edges touching this vertex
+};
+
+struct Graph_Edge
+{
+    int from = -1, to = -1;
+    vector<Point> pixels;   // Chain from "from" (excluded) to "to" (included)
+    vector<int> costs;      // Cost from "from" to pixels[i] in G_DIRECT/G_SKEW units
+    double length = 0;      // Euclidean length of the chain in pixels
+    int cost() const { return costs.empty() ? 0 : costs.back(); }
+};
+
+class Roadmap_Graph
+{
+    /*************************************************************
+     *  Topological graph of a one pixel wide roadmap skeleton
+     *  (Voronoi diagram or boustrophedon decomposition).
+     *
+     *  Staircase corners of the skeleton ( XX. over .XX ) are
+     *  dropped first, the chain takes the diagonal step past them
+     *  like the pixel search does. Otherwise the two pixels of every
+     *  corner would have 3 neighbors and become junctions. A dropped
+     *  pixel hangs off a kept neighbor ( its anchor ), the paths from
+     *  and to it take one step to the anchor. Where a 4-connected
+     *  staircase meets a junction the kept diagonal is not always
+     *  the shorter side, so a path can cost a few G_DIRECT more than
+     *  the same query on the pixel grid. Lengths measured on the
+     *  graph are therefore not the pixel A* lengths of earlier runs.
+     *
+     *  Every kept pixel with 1 or 3+ kept neighbors becomes a vertex
+     *  (endpoints and junctions). The runs of pixels with exactly
+     *  2 kept neighbors between them become edges, which keep their
+     *  pixel chain, so a path found on the graph can be unrolled to
+     *  the same pixel format as A_Star::get_path. A closed loop with
+     *  no junction gets one artificial vertex.
+     *
+     *  Searching the graph visits tens of vertices where the grid
+     *  search visits thousands of pixels. The graph is not changed by
+     *  a search, the const find_path and find_paths are thread-safe
+     *  as long as every thread has its own Search_Workspace.
+     ************************************************************/
+    public:
+        Roadmap_Graph();
+
+        /**
+         * @brief Roadmap_Graph
+         * @param road_map => BGR image with the roadmap drawn as red pixels
+         */
+        Roadmap_Graph( const cv::Mat &road_map );
+
+        /**
+         * @brief build -> Extract vertices and edges from the roadmap pixels
+         * @param road_map
+         */
+        void build( const cv::Mat &road_map );
+
+        /**
+         * @brief find_path -> Shortest path between two roadmap pixels
+         * @param start => Must be a roadmap pixel
+         * @param goal => Must be a roadmap pixel
+         * @param path => Cleared and filled with the pixel path, start
+         *      excluded and goal included ( same as A_Star::get_path )
+         * @return true if a path was found
+         */
+        bool find_path( const cv::Point &start,
+                        const cv::Point &goal,
+                        std::vector<cv::Point> &path,
+                        Search_Workspace &workspace ) const;
+
+        /**
+         * @brief find_path -> As above with the workspace of this object,
+         *      not thread-safe
+         */
+        bool find_path( const cv::Point &start,
+                        const cv::Point &goal,
+                        std::vector<cv::Point> &path );
+
+        /**
+         * @brief find_paths -> Search all queries spread over the pool
+         * @param queries => ( start, goal ) pairs
+         * @param paths => paths[i] is the path of queries[i], empty if
+         *      none was found
+         * @param pool
+         */
+        void find_paths( const std::vector<std::pair<cv::Point, cv::Point>> &queries,
+                         std::vector<std::vector<cv::Point>> &paths,
+                         Thread_Pool &pool ) const;
+
+        /**
+         * @brief locate -> Where a roadmap pixel sits in the graph
+         * @param p
+         * @param vertex => Vertex id or -1
+         * @param edge => Edge id or -1 ( only set when not a vertex )
+         * @param index => Position of p in the edge chain
+         * @return false if p is not a kept roadmap pixel, see anchor
+         */
+        bool locate( const cv::Point &p, int &vertex, int &edge, int &index ) const;
+
+        /**
+         * @brief anchor
+         * @param p
+         * @return p for a kept roadmap pixel, the kept neighbor of a
+         *      dropped corner, Point( -1, -1 ) if p is not on the roadmap
+         */
+        cv::Point anchor( const cv::Point &p ) const;
+
+        /**
+         * @brief anchors -> Anchors of both ends of a query
+         * @param start
+         * @param goal
+         * @param start_anchor
+         * @param goal_anchor
+         * @return false if start == goal or one is not on the roadmap
+         */
+        bool anchors( const cv::Point &start, const cv::Point &goal,
+                      cv::Point &start_anchor, cv::Point &goal_anchor ) const;
+
+        /**
+         * @brief attach_ends -> Turn a path between the anchors of start and
+         *      goal into one between start and goal
+         * @param start
+         * @param goal
+         * @param path => Path from the start anchor to the goal anchor,
+         *      empty if both are the same pixel
+         */
+        void attach_ends( const cv::Point &start, const cv::Point &goal,
+                          std::vector<cv::Point> &path ) const;
+
+        /**
+         * @brief end_cost -> What attach_ends adds to a path
+         * @param start
+         * @param goal
+         * @param steps => Added pixels
+         * @return Added cost in G_DIRECT/G_SKEW units
+         */
+        int end_cost( const cv::Point &start, const cv::Point &goal, int &steps ) const;
+
+        /**
+         * @brief chain_point -> Pixel at position i of an edge chain,
+         *      where -1 is the "from" vertex and size-1 the "to" vertex
+         * @param edge
+         * @param i
+         * @return
+         */
+        cv::Point chain_point( const Graph_Edge &edge, const int i ) const;
+
+        /**
+         * @brief chain_cost -> Cost from the "from" vertex to position i
+         * @param edge
+         * @param i
+         * @return
+         */
+        int chain_cost( const Graph_Edge &edge, const int i ) const;
+
+        /**
+         * @brief append_chain -> Append the chain pixels after position a
+         *      up to and including position b, in either direction
+         * @param edge
+         * @param a
+         * @param b
+         * @param path
+         */
+        void append_chain( const Graph_Edge &edge, int a, const int b,
+                           std::vector<cv::Point> &path ) const;
+
+        const std::vector<Graph_Vertex> &get_vertices() const;
+        const std::vector<Graph_Edge> &get_edges() const;
+        int get_width() const;
+        int get_height() const;
+
+        /**
+         * @brief make_fingerprint -> Hash of the vertices and edges, for
+         *      tables saved next to the roadmap
+         * @return
+         */
+        unsigned long long make_fingerprint() const;
+
+        /**
+         * @brief draw -> Vertices blue, edges red on a copy of img
+         * @param img
+         * @return
+         */
+        cv::Mat draw( const cv::Mat &img ) const;
+
+        ~Roadmap_Graph();
+
+    private:
+        int width = 0, height = 0;
+        std::vector<Graph_Vertex> vertices;
+        std::vector<Graph_Edge> edges;
+        std::vector<int> vertex_of;   // Per pixel, -1 = not a vertex
+        std::vector<int> edge_of;     // Per pixel, -1 = not on an edge chain
+        std::vector<int> index_of;    // Per pixel, position in the edge chain
+        std::vector<int> anchor_of;   // Per pixel, y * width + x of its anchor, -1 = not on the roadmap
+
+        Search_Workspace default_workspace; // Used by the single threaded find_path
+
+        bool find_kept_path( const cv::Point &start,
+                             const cv::Point &goal,
+                             std::vector<cv::Point> &path,
+                             Search_Workspace &workspace ) const;
+        void trace( const int v, const std::vector<uchar> &red );
+        void add_edge( Graph_Edge &edge );
+        int compute_h( const cv::Point &p1, const cv::Point &p2 ) const;
+};
+
+#endif // ROADMAP_GRAPH_H
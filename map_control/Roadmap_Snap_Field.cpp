@@ -0,0 +1,183 @@
+#include "Roadmap_Snap_Field.h"
+#include "Grid_Map.h"
+#include "Thread_Pool.h"
+
+#include <climits>
+#include <cmath>
+
+// -----------------------------------------------------------------------
+
+Roadmap_Snap_Field::Roadmap_Snap_Field() {}
+
+// -----------------------------------------------------------------------
+
+Roadmap_Snap_Field::Roadmap_Snap_Field( const cv::Mat &roadmap, const int threads )
+{
+    build( roadmap, threads );
+}
+
+// -----------------------------------------------------------------------
+
+Roadmap_Snap_Field::~Roadmap_Snap_Field() {}
+
+// -----------------------------------------------------------------------
+
+void Roadmap_Snap_Field::build( const cv::Mat &roadmap, const int threads )
+{
+    width = roadmap.cols;
+    height = roadmap.rows;
+    fingerprint = make_fingerprint( roadmap );
+    nearest.assign( (size_t)width * height, -1 );
+    distances.assign( (size_t)width * height, -1.0f );
+
+    std::vector<uchar> is_roadmap( (size_t)width * height, 0 );
+    for (int y = 0; y < height; y++)
+    {
+        const Vec3b *row = roadmap.ptr<Vec3b>( y );
+        for (int x = 0; x < width; x++)
+            if ( row[x] == Vec3b(0,0,255) ) // If pixel red => roadmap
+                is_roadmap[ y * width + x ] = 1;
+    }
+    Line_Of_Sight sight( roadmap, Scalar(0,0,0) );
+
+    // One row per task, the pixels only write their own entries
+    Thread_Pool pool( threads );
+    pool.parallel_for( height, [&]( size_t y, int )
+    {
+        for (int x = 0; x < width; x++)
+            if ( !sight.is_obstacle( Point( x, (int)y ) ) )
+                search( x, (int)y, is_roadmap, sight );
+    } );
+}
+
+// -----------------------------------------------------------------------
+
+void Roadmap_Snap_Field::search( const int x, const int y,
+                                 const std::vector<uchar> &is_roadmap,
+                                 const Line_Of_Sight &sight )
+{
+    long long best_d2 = LLONG_MAX;
+    int best = -1;
+
+    // Ring k holds the pixels with max( |dx|, |dy| ) = k, all of them are at least k away
+    int max_k = max( width, height );
+    for (int k = 0; k <= max_k && (long long)k * k <= best_d2; k++)
+    {
+        int y0 = max( y - k, 0 ), y1 = min( y + k, height - 1 );
+        for (int ry = y0; ry <= y1; ry++)
+        {
+            // Whole row on the top and bottom edge, else only the left and right pixel
+            bool edge = ( ry == y - k || ry == y + k );
+            int step = ( edge || k == 0 ) ? 1 : 2 * k;
+            for (int rx = x - k; rx <= x + k; rx += step)
+            {
+                if ( rx < 0 || rx >= width )
+                    continue;
+
+                int id = ry * width + rx;
+                if ( !is_roadmap[id] )
+                    continue;
+
+                long long d2 = (long long)( rx - x ) * ( rx - x ) + (long long)( ry - y ) * ( ry - y );
+                if ( d2 > best_d2 || ( d2 == best_d2 && id < best ) ) // Ties => last in row order
+                    continue;
+
+                if ( sight.visible( Point( rx, ry ), Point( x, y ) ) ) // Same direction as findWayToRoadMap
+                {
+                    best_d2 = d2;
+                    best = id;
+                }
+            }
+        }
+    }
+
+    if ( best >= 0 )
+    {
+        nearest[ y * width + x ] = best;
+        distances[ y * width + x ] = (float)sqrt( (double)best_d2 );
+    }
+}
+
+// -----------------------------------------------------------------------
+
+unsigned long long Roadmap_Snap_Field::make_fingerprint( const cv::Mat &roadmap )
+{
+    Fingerprint hash;
+    hash.add_image( roadmap );
+    return hash.get();
+}
+
+// -----------------------------------------------------------------------
+
+bool Roadmap_Snap_Field::save( const std::string &file ) const
+{
+    ofstream out( file, ios::binary );
+    if ( !out )
+        return false;
+
+    write_header( out, "RSF2", fingerprint );
+    write_binary( out, width );
+    write_binary( out, height );
+    write_binary( out, nearest );
+    write_binary( out, distances );
+    return (bool)out;
+}
+
+// -----------------------------------------------------------------------
+
+bool Roadmap_Snap_Field::load( const std::string &file, const cv::Mat &roadmap )
+{
+    unsigned long long map_fingerprint = make_fingerprint( roadmap );
+    ifstream in( file, ios::binary );
+    if ( !in || !read_header( in, "RSF2", map_fingerprint ) )
+        return false; // Made from another roadmap
+
+    int file_width = 0, file_height = 0;
+    read_binary( in, file_width );
+    read_binary( in, file_height );
+    if ( !in || file_width != roadmap.cols || file_height != roadmap.rows )
+        return false;
+
+    size_t size = (size_t)file_width * file_height;
+    std::vector<int> file_nearest( size );
+    std::vector<float> file_distances( size );
+    read_binary( in, file_nearest );
+    read_binary( in, file_distances );
+    if ( !in )
+        return false;
+
+    width = file_width;
+    height = file_height;
+    fingerprint = map_fingerprint;
+    nearest.swap( file_nearest );
+    distances.swap( file_distances );
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+cv::Point Roadmap_Snap_Field::snap( const cv::Point &p ) const
+{
+    int id = nearest[ p.y * width + p.x ];
+    if ( id < 0 )
+        return Point( -1, -1 );
+    return Point( id % width, id / width );
+}
+
+// -----------------------------------------------------------------------
+
+bool Roadmap_Snap_Field::has_snap( const cv::Point &p ) const { return nearest[ p.y * width + p.x ] >= 0; }
+
+// -----------------------------------------------------------------------
+
+float Roadmap_Snap_Field::distance( const cv::Point &p ) const { return distances[ p.y * width + p.x ]; }
+
+// -----------------------------------------------------------------------
+
+int Roadmap_Snap_Field::get_width() const { return width; }
+
+// -----------------------------------------------------------------------
+
+int Roadmap_Snap_Field::get_height() const { return height; }
+
+// -----------------------------------------------------------------------
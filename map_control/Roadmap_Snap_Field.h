@@ -0,0 +1,107 @@
+#ifndef ROADMAP_SNAP_FIELD_H
+#define ROADMAP_SNAP_FIELD_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Line_Of_Sight.h"
+
+using namespace std;
+using namespace cv;
+
+class Roadmap_Snap_Field
+{
+    /*************************************************************
+     *  The nearest visible roadmap pixel of every free pixel, so
+     *  snapping a query point to the roadmap is one lookup instead
+     *  of a line of sight test to every roadmap pixel.
+     *
+     *  The result is the same as A_Star::findWayToRoadMap with the
+     *  roadmap points of A_Star::calculateRoadmapPoints: the closest
+     *  red pixel with no black pixel on the line to it, and on equal
+     *  distance the last one in row order.
+     *
+     *  Every pixel searches rings of growing size around itself and
+     *  stops when no closer roadmap pixel can follow, the rows are
+     *  spread over all cores. The field can be saved next to the
+     *  roadmap, a fingerprint of the roadmap makes sure it belongs
+     *  to it.
+     ************************************************************/
+    public:
+        Roadmap_Snap_Field();
+
+        /**
+         * @brief Roadmap_Snap_Field
+         * @param roadmap => BGR image, red = roadmap, black = obstacle
+         * @param threads => 0 = one per core
+         */
+        Roadmap_Snap_Field( const cv::Mat &roadmap, const int threads = 0 );
+
+        /**
+         * @brief build -> Search the nearest visible roadmap pixel of every pixel
+         * @param roadmap
+         * @param threads => 0 = one per core
+         */
+        void build( const cv::Mat &roadmap, const int threads = 0 );
+
+        /**
+         * @brief save -> Write the field to a binary file
+         * @param file => e.g. "voronoi_roadmap.png.snap"
+         * @return
+         */
+        bool save( const std::string &file ) const;
+
+        /**
+         * @brief load -> Read a field written by save()
+         * @param file
+         * @param roadmap => The roadmap the field was built from
+         * @return false if the file is missing or belongs to another roadmap
+         */
+        bool load( const std::string &file, const cv::Mat &roadmap );
+
+        /**
+         * @brief snap
+         * @param p
+         * @return The nearest visible roadmap pixel, Point( -1, -1 )
+         *      if there is none, see has_snap
+         */
+        cv::Point snap( const cv::Point &p ) const;
+
+        /**
+         * @brief has_snap
+         * @param p
+         * @return true if a roadmap pixel is visible from p
+         */
+        bool has_snap( const cv::Point &p ) const;
+
+        /**
+         * @brief distance
+         * @param p
+         * @return Euclidean distance to snap( p ), -1 if there is none
+         */
+        float distance( const cv::Point &p ) const;
+
+        int get_width() const;
+        int get_height() const;
+
+        ~Roadmap_Snap_Field();
+
+    private:
+        int width = 0, height = 0;
+        unsigned long long fingerprint = 0;
+        std::vector<int> nearest;       // Index image, y * width + x of the roadmap pixel, -1 = none
+        std::vector<float> distances;   // Distance image, -1 = none
+
+        static unsigned long long make_fingerprint( const cv::Mat &roadmap );
+
+        void search( const int x, const int y,
+                     const std::vector<uchar> &is_roadmap,
+                     const Line_Of_Sight &sight );
+};
+
+#endif // ROADMAP_SNAP_FIELD_H
@@ -0,0 +1,507 @@
+#include "Room_Planner.h"
+#include "Grid_Map.h"
+
+#include <climits>
+#include <map>
+
+// -----------------------------------------------------------------------
+
+Room_Planner::Room_Planner() {}
+
+// -----------------------------------------------------------------------
+
+Room_Planner::Room_Planner( const cv::Mat &floor_plan )
+{
+    DetectRooms detect_rooms;
+    build( floor_plan, detect_rooms.brushfireFindCenters( floor_plan ) );
+}
+
+// -----------------------------------------------------------------------
+
+Room_Planner::~Room_Planner() {}
+
+// -----------------------------------------------------------------------
+
+void Room_Planner::build( const cv::Mat &floor_plan,
+                          const std::vector<cv::Point> &centers,
+                          const int threads )
+{
+    width = floor_plan.cols;
+    height = floor_plan.rows;
+    size_t size = (size_t)width * height;
+
+    room_of.assign( size, -1 );
+    portal_of.assign( size, -1 );
+    portals.clear();
+    room_portals.clear();
+
+    // -2 = free but not in a room yet
+    for (int y = 0; y < height; y++)
+    {
+        const Vec3b *row = floor_plan.ptr<Vec3b>( y );
+        for (int x = 0; x < width; x++)
+            if ( row[x] != Vec3b(0,0,0) ) // If pixel not black => free
+                room_of[ y * width + x ] = -2;
+    }
+
+    default_pixels.resize( size );
+    grow_rooms( centers );
+    place_portals();
+
+    // A room only writes the edges of its own portals
+    Thread_Pool pool( threads );
+    std::vector<Search_Workspace> workspaces( pool.get_thread_count() );
+    pool.parallel_for( rooms, [&]( size_t room, int thread )
+    {
+        connect_room( (int)room, workspaces[thread] );
+    } );
+
+    default_portals.resize( portals.size() );
+}
+
+// -----------------------------------------------------------------------
+
+int Room_Planner::compute_g( const int id1, const int id2 ) const
+{
+    int dx = abs( id1 % width - id2 % width );
+    int dy = abs( id1 / width - id2 / width );
+
+    if ( dx > dy )
+        return G_SKEW * dy + G_DIRECT * ( dx - dy );
+    else
+        return G_SKEW * dx + G_DIRECT * ( dy - dx );
+}
+
+// -----------------------------------------------------------------------
+
+void Room_Planner::grow_rooms( const std::vector<cv::Point> &centers )
+{
+    // Multi source Dijkstra, every free pixel joins the closest center
+    Search_Workspace &w = default_pixels;
+    w.next_generation();
+    w.open_list.clear();
+    rooms = 0;
+
+    auto seed = [&]( const int id )
+    {
+        room_of[id] = rooms++;
+        w.seen[id] = w.generation;
+        w.g[id] = 0;
+        w.open_list.push( id, 0 );
+    };
+
+    auto grow = [&]()
+    {
+        while ( !w.open_list.empty() )
+        {
+            int id = w.open_list.pop();
+            w.closed[id] = w.generation;
+
+            int x = id % width, y = id / width;
+            for (int k = 0; k < 8; k++)
+            {
+                int nx = x + NEIGHBOR_DX[k], ny = y + NEIGHBOR_DY[k];
+                if ( nx < 0 || ny < 0 || nx >= width || ny >= height )
+                    continue;
+
+                int n = ny * width + nx;
+                if ( room_of[n] == -1 || w.closed[n] == w.generation )
+                    continue;
+
+                int new_g = w.g[id] + compute_g( n, id );
+                if ( w.seen[n] != w.generation || new_g < w.g[n] )
+                {
+                    w.seen[n] = w.generation;
+                    w.g[n] = new_g;
+                    room_of[n] = room_of[id];
+                    w.open_list.push( n, new_g );
+                }
+            }
+        }
+    };
+
+    for ( auto& c : centers )
+    {
+        if ( c.x < 0 || c.y < 0 || c.x >= width || c.y >= height )
+            continue;
+        int id = c.y * width + c.x;
+        if ( room_of[id] == -2 ) // Skip centers on obstacles and duplicates
+            seed( id );
+    }
+    grow();
+
+    // Free areas without a detected center become rooms of their own
+    for (size_t id = 0; id < room_of.size(); id++)
+        if ( room_of[id] == -2 )
+        {
+            seed( (int)id );
+            grow();
+        }
+
+    room_portals.assign( rooms, std::vector<int>() );
+}
+
+// -----------------------------------------------------------------------
+
+int Room_Planner::add_portal( const int id )
+{
+    if ( portal_of[id] >= 0 )
+        return portal_of[id];
+
+    Room_Portal portal;
+    portal.point = Point( id % width, id / width );
+    portal.room = room_of[id];
+    portal_of[id] = (int)portals.size();
+    room_portals[portal.room].push_back( portal_of[id] );
+    portals.push_back( portal );
+    return portal_of[id];
+}
+
+// -----------------------------------------------------------------------
+
+void Room_Planner::place_portals()
+{
+    // Boundary pixels of room a that touch room b, for every pair a < b
+    std::map<std::pair<int, int>, std::vector<int>> boundaries;
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+        {
+            int a = room_of[ y * width + x ];
+            if ( a < 0 )
+                continue;
+
+            for (int k = 0; k < 8; k++)
+            {
+                int nx = x + NEIGHBOR_DX[k], ny = y + NEIGHBOR_DY[k];
+                if ( nx < 0 || ny < 0 || nx >= width || ny >= height )
+                    continue;
+
+                int b = room_of[ ny * width + nx ];
+                if ( b > a )
+                {
+                    std::vector<int> &v = boundaries[ std::make_pair( a, b ) ];
+                    if ( v.empty() || v.back() != y * width + x )
+                        v.push_back( y * width + x );
+                }
+            }
+        }
+
+    // Every connected run of boundary pixels is one doorway
+    std::vector<uchar> boundary( room_of.size(), 0 );
+    std::vector<int> doorway;
+    for ( auto& rooms_boundary : boundaries )
+    {
+        int b = rooms_boundary.first.second;
+        std::vector<int> &pixels = rooms_boundary.second;
+        for ( auto& id : pixels )
+            boundary[id] = 1;
+
+        for ( auto& first : pixels )
+        {
+            if ( boundary[first] != 1 )
+                continue;
+
+            doorway.clear();
+            doorway.push_back( first );
+            boundary[first] = 2;
+            for (size_t i = 0; i < doorway.size(); i++)
+            {
+                int x = doorway[i] % width, y = doorway[i] / width;
+                for (int k = 0; k < 8; k++)
+                {
+                    int nx = x + NEIGHBOR_DX[k], ny = y + NEIGHBOR_DY[k];
+                    if ( nx < 0 || ny < 0 || nx >= width || ny >= height )
+                        continue;
+                    int n = ny * width + nx;
+                    if ( boundary[n] == 1 )
+                    {
+                        boundary[n] = 2;
+                        doorway.push_back( n );
+                    }
+                }
+            }
+
+            // Portal pair in the middle of the doorway
+            int p = doorway[ doorway.size() / 2 ], q = -1;
+            int x = p % width, y = p / width;
+            for (int k = 0; k < 8 && q < 0; k++)
+            {
+                int nx = x + NEIGHBOR_DX[k], ny = y + NEIGHBOR_DY[k];
+                if ( nx >= 0 && ny >= 0 && nx < width && ny < height &&
+                     room_of[ ny * width + nx ] == b )
+                    q = ny * width + nx;
+            }
+
+            int pa = add_portal( p ), pb = add_portal( q );
+            bool connected = false;
+            for ( auto& e : portals[pa].edges )
+                connected = connected || ( e.to == pb );
+            if ( !connected )
+            {
+                Portal_Edge e;
+                e.cost = compute_g( p, q );
+                e.to = pb;
+                portals[pa].edges.push_back( e );
+                e.to = pa;
+                portals[pb].edges.push_back( e );
+            }
+        }
+
+        for ( auto& id : pixels )
+            boundary[id] = 0;
+    }
+}
+
+// -----------------------------------------------------------------------
+
+void Room_Planner::search_room( const int source, Search_Workspace &workspace,
+                                const int goal ) const
+{
+    Search_Workspace &w = workspace;
+    const int room = room_of[source];
+
+    w.resize( room_of.size() );
+    w.next_generation();
+    w.open_list.clear();
+    w.seen[source] = w.generation;
+    w.g[source] = 0;
+    w.parent[source] = -1;
+    w.open_list.push( source, 0 );
+
+    while ( !w.open_list.empty() )
+    {
+        int id = w.open_list.pop();
+        w.closed[id] = w.generation;
+        if ( id == goal )
+            break;
+
+        int x = id % width, y = id / width;
+        for (int k = 0; k < 8; k++)
+        {
+            int nx = x + NEIGHBOR_DX[k], ny = y + NEIGHBOR_DY[k];
+            if ( nx < 0 || ny < 0 || nx >= width || ny >= height )
+                continue;
+
+            int n = ny * width + nx;
+            if ( room_of[n] != room || w.closed[n] == w.generation )
+                continue;
+
+            int new_g = w.g[id] + compute_g( n, id );
+            if ( w.seen[n] != w.generation || new_g < w.g[n] )
+            {
+                w.seen[n] = w.generation;
+                w.g[n] = new_g;
+                w.parent[n] = id;
+                w.open_list.push( n, new_g );
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+
+void Room_Planner::connect_room( const int room, Search_Workspace &workspace )
+{
+    const std::vector<int> &ids = room_portals[room];
+    for ( auto& from : ids )
+    {
+        int source = portals[from].point.y * width + portals[from].point.x;
+        search_room( source, workspace );
+
+        for ( auto& to : ids )
+        {
+            int target = portals[to].point.y * width + portals[to].point.x;
+            if ( to == from || workspace.closed[target] != workspace.generation )
+                continue;
+
+            Portal_Edge e;
+            e.to = to;
+            e.cost = workspace.g[target];
+            for (int id = target; id != source; id = workspace.parent[id])
+                e.pixels.push_back( Point( id % width, id / width ) );
+            reverse( e.pixels.begin(), e.pixels.end() );
+            portals[from].edges.push_back( e );
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+
+bool Room_Planner::find_path( const cv::Point &start,
+                              const cv::Point &goal,
+                              std::vector<cv::Point> &path )
+{
+    return find_path( start, goal, path, default_pixels, default_portals );
+}
+
+// -----------------------------------------------------------------------
+
+bool Room_Planner::find_path( const cv::Point &start,
+                              const cv::Point &goal,
+                              std::vector<cv::Point> &path,
+                              Search_Workspace &pixel_workspace,
+                              Search_Workspace &portal_workspace ) const
+{
+    path.clear();
+    if ( start == goal || get_room( start ) < 0 || get_room( goal ) < 0 )
+        return false;
+
+    const int s = start.y * width + start.x;
+    const int t = goal.y * width + goal.x;
+    Search_Workspace &pixels = pixel_workspace;
+    Search_Workspace &w = portal_workspace;
+    w.resize( portals.size() );
+    w.next_generation();
+    w.open_list.clear();
+
+    // Pixel search in the start room, its portals are the roots of the portal search
+    search_room( s, pixels );
+    int best = INT_MAX, best_portal = -1;
+    if ( room_of[s] == room_of[t] && pixels.closed[t] == pixels.generation )
+        best = pixels.g[t]; // Without leaving the room
+
+    for ( auto& k : room_portals[ room_of[s] ] )
+    {
+        int id = portals[k].point.y * width + portals[k].point.x;
+        if ( pixels.closed[id] != pixels.generation )
+            continue;
+        w.seen[k] = w.generation;
+        w.g[k] = pixels.g[id];
+        w.parent[k] = -1;
+        long long h = compute_g( id, t );
+        w.open_list.push( k, ( ( w.g[k] + h ) << 32 ) | h );
+    }
+
+    // Pixel search in the goal room gives the cost from its portals to the goal
+    search_room( t, pixels );
+
+    while ( !w.open_list.empty() )
+    {
+        if ( ( w.open_list.top_key() >> 32 ) >= best ) // Nothing left can beat best
+            break;
+
+        int u = w.open_list.pop();
+        w.closed[u] = w.generation;
+
+        const Room_Portal &portal = portals[u];
+        int id = portal.point.y * width + portal.point.x;
+        if ( portal.room == room_of[t] && pixels.closed[id] == pixels.generation &&
+             w.g[u] + pixels.g[id] < best )
+        {
+            best = w.g[u] + pixels.g[id];
+            best_portal = u;
+        }
+
+        for ( auto& e : portal.edges )
+        {
+            if ( w.closed[e.to] == w.generation )
+                continue;
+
+            int new_g = w.g[u] + e.cost;
+            if ( w.seen[e.to] != w.generation || new_g < w.g[e.to] )
+            {
+                w.seen[e.to] = w.generation;
+                w.g[e.to] = new_g;
+                w.parent[e.to] = u;
+                const Point &p = portals[e.to].point;
+                long long h = compute_g( p.y * width + p.x, t );
+                w.open_list.push( e.to, ( ( new_g + h ) << 32 ) | h );
+            }
+        }
+    }
+
+    if ( best == INT_MAX ) // Havent found goal
+        return false;
+
+    if ( best_portal < 0 ) // Straight to the goal inside the room
+    {
+        search_room( s, pixels, t );
+        for (int id = t; id != s; id = pixels.parent[id])
+            path.push_back( Point( id % width, id / width ) );
+        reverse( path.begin(), path.end() );
+        return true;
+    }
+
+    // Last portal to the goal, while the goal room search is still valid
+    std::vector<int> &tail = pixels.route;
+    tail.clear();
+    int last = portals[best_portal].point.y * width + portals[best_portal].point.x;
+    for (int id = pixels.parent[last]; id != -1; id = pixels.parent[id])
+        tail.push_back( id );
+
+    // Portals from the first one in the start room to the last one
+    std::vector<int> &route = w.route;
+    route.clear();
+    for (int k = best_portal; k != -1; k = w.parent[k])
+        route.push_back( k );
+    reverse( route.begin(), route.end() );
+
+    // Start to the first portal
+    int first = portals[ route[0] ].point.y * width + portals[ route[0] ].point.x;
+    if ( first != s )
+    {
+        search_room( s, pixels, first );
+        for (int id = first; id != s; id = pixels.parent[id])
+            path.push_back( Point( id % width, id / width ) );
+        reverse( path.begin(), path.end() );
+    }
+
+    // Cached paths inside the rooms and the steps through the doorways
+    for (size_t i = 1; i < route.size(); i++)
+    {
+        const Portal_Edge *edge = 0;
+        for ( auto& e : portals[ route[i-1] ].edges )
+            if ( e.to == route[i] && ( edge == 0 || e.cost < edge->cost ) )
+                edge = &e;
+
+        if ( edge->pixels.empty() )
+            path.push_back( portals[ route[i] ].point );
+        else
+            path.insert( path.end(), edge->pixels.begin(), edge->pixels.end() );
+    }
+
+    for ( auto& id : tail )
+        path.push_back( Point( id % width, id / width ) );
+
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+int Room_Planner::get_room( const cv::Point &p ) const
+{
+    if ( p.x < 0 || p.y < 0 || p.x >= width || p.y >= height )
+        return -1;
+    return room_of[ p.y * width + p.x ];
+}
+
+// -----------------------------------------------------------------------
+
+int Room_Planner::get_room_count() const { return rooms; }
+
+// -----------------------------------------------------------------------
+
+const std::vector<Room_Portal> &Room_Planner::get_portals() const { return portals; }
+
+// -----------------------------------------------------------------------
+
+cv::Mat Room_Planner::draw( const cv::Mat &img ) const
+{
+    Mat result = img.clone();
+
+    RNG rng( 12345 );
+    std::vector<Vec3b> colors( rooms );
+    for ( auto& c : colors )
+        c = Vec3b( rng.uniform( 64, 256 ), rng.uniform( 64, 256 ), rng.uniform( 64, 256 ) );
+
+    for (int y = 0; y < height; y++)
+        for (int x = 0; x < width; x++)
+            if ( room_of[ y * width + x ] >= 0 )
+                result.at<Vec3b>( y, x ) = colors[ room_of[ y * width + x ] ];
+
+    for ( auto& p : portals )
+        result.at<Vec3b>( p.point ) = Vec3b(255,0,0);
+    return result;
+}
+
+// -----------------------------------------------------------------------
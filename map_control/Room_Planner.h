@@ -0,0 +1,142 @@
+#ifndef ROOM_PLANNER_H
+#define ROOM_PLANNER_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+#include "opencv2/imgcodecs.hpp"
+#include "opencv2/highgui.hpp"
+#include "opencv2/imgproc.hpp"
+
+#include <iostream>
+#include <vector>
+
+#include "DetectRooms.h"
+#include "Search_Workspace.h"
+#include "Thread_Pool.h"
+
+using namespace std;
+using namespace cv;
+
+struct Portal_Edge
+{
+    int to = -1;
+    int cost = 0;           // In G_DIRECT/G_SKEW units
+    vector<Point> pixels;   // Cached path, from excluded and to included. Empty between two rooms.
+};
+
+struct Room_Portal
+{
+    Point point;
+    int room = -1;
+    vector<Portal_Edge> edges;
+};
+
+class Room_Planner
+{
+    /*************************************************************
+     *  Hierarchical (HPA* style) planner on a floor plan.
+     *
+     *  The free pixels are split into rooms by growing a region from
+     *  every room center ( DetectRooms::brushfireFindCenters ), each
+     *  pixel joins the closest center. Where two rooms touch, one
+     *  portal pair is placed in the middle of every doorway. The
+     *  costs and pixel paths between the portals of a room are
+     *  searched once when the planner is built.
+     *
+     *  A query only searches pixels inside the start room and the
+     *  goal room, the rest is an A* over the portals, so the query
+     *  time depends on the number of rooms and not on the size of
+     *  the floor plan. Like HPA* the path goes through the middle of
+     *  the doorways, so it can be longer than the optimal pixel path,
+     *  most for short queries between neighboring rooms.
+     ************************************************************/
+    public:
+        Room_Planner();
+
+        /**
+         * @brief Room_Planner -> Build with the rooms found by DetectRooms
+         * @param floor_plan => BGR image, black pixels are obstacles
+         */
+        Room_Planner( const cv::Mat &floor_plan );
+
+        /**
+         * @brief build -> Split into rooms, place portals and cache the
+         *      paths between portals of the same room
+         * @param floor_plan => BGR image, black pixels are obstacles
+         * @param centers => One point per room, points on obstacles are skipped
+         * @param threads => Rooms are searched in parallel, 0 = one per core
+         */
+        void build( const cv::Mat &floor_plan,
+                    const std::vector<cv::Point> &centers,
+                    const int threads = 0 );
+
+        /**
+         * @brief find_path -> Path between two free pixels
+         * @param start
+         * @param goal
+         * @param path => Cleared and filled with the path, start excluded
+         *      and goal included ( same as A_Star::get_path )
+         * @param pixel_workspace => Workspace of the searches inside the rooms
+         * @param portal_workspace => Workspace of the search over the portals
+         * @return true if a path was found
+         */
+        bool find_path( const cv::Point &start,
+                        const cv::Point &goal,
+                        std::vector<cv::Point> &path,
+                        Search_Workspace &pixel_workspace,
+                        Search_Workspace &portal_workspace ) const;
+
+        /**
+         * @brief find_path -> As above with the workspaces of this object,
+         *      not thread-safe
+         */
+        bool find_path( const cv::Point &start,
+                        const cv::Point &goal,
+                        std::vector<cv::Point> &path );
+
+        /**
+         * @brief get_room
+         * @param p
+         * @return Room id of the pixel, -1 for obstacles
+         */
+        int get_room( const cv::Point &p ) const;
+
+        int get_room_count() const;
+        const std::vector<Room_Portal> &get_portals() const;
+
+        /**
+         * @brief draw -> Rooms in random colors and portals blue on a copy of img
+         * @param img
+         * @return
+         */
+        cv::Mat draw( const cv::Mat &img ) const;
+
+        ~Room_Planner();
+
+    private:
+        int width = 0, height = 0, rooms = 0;
+        std::vector<int> room_of;                   // Per pixel, -1 = obstacle
+        std::vector<int> portal_of;                 // Per pixel, -1 = not a portal
+        std::vector<Room_Portal> portals;
+        std::vector<std::vector<int>> room_portals; // Portal ids of every room
+
+        Search_Workspace default_pixels, default_portals;
+
+        void grow_rooms( const std::vector<cv::Point> &centers );
+        void place_portals();
+        int add_portal( const int id );
+        void connect_room( const int room, Search_Workspace &workspace );
+
+        /**
+         * @brief search_room -> Dijkstra from a pixel over its own room
+         * @param source
+         * @param workspace => g and parent of every pixel of the room
+         * @param goal => Stop when this pixel is closed, -1 = whole room
+         */
+        void search_room( const int source, Search_Workspace &workspace,
+                          const int goal = -1 ) const;
+
+        int compute_g( const int id1, const int id2 ) const;
+};
+
+#endif // ROOM_PLANNER_H
@@ -0,0 +1,99 @@
+#ifndef SEARCH_OBSERVER_H
+#define SEARCH_OBSERVER_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+
+#include <vector>
+
+using namespace std;
+using namespace cv;
+
+/*************************************************************
+ *  Observers of a grid search, passed as template argument so
+ *  the calls are resolved at compile time.
+ *
+ *  on_expand( p ) => p is taken from the open list
+ *  on_open( p )   => p is put on the open list
+ *  on_path( v )   => the path was found, same format as get_path
+ *
+ *  The null observer has empty inline functions, with it the
+ *  search compiles to the same code as without any hooks.
+ ************************************************************/
+
+class Null_Search_Observer
+{
+    public:
+        void on_expand( const cv::Point & ) {}
+        void on_open( const cv::Point & ) {}
+        void on_path( const std::vector<cv::Point> & ) {}
+};
+
+// -----------------------------------------------------------------------
+
+class Draw_Search_Observer
+{
+    /*************************************************************
+     *  Draws the search on an image, nodes that have been on the
+     *  open list gray and the path red.
+     ************************************************************/
+    public:
+        /**
+         * @brief Draw_Search_Observer
+         * @param img => Drawn on directly, shares the data of the Mat
+         * @param start => Not drawn
+         * @param goal => Not drawn
+         * @param draw_open => false = only the path
+         */
+        Draw_Search_Observer( cv::Mat &img,
+                              const cv::Point &start,
+                              const cv::Point &goal,
+                              const bool draw_open = true )
+            : img( img ), start( start ), goal( goal ), draw_open( draw_open ) {}
+
+        void on_expand( const cv::Point & ) {}
+
+        void on_open( const cv::Point &p )
+        {
+            if ( draw_open && p != start && p != goal )
+                img.at<Vec3b>( p ) = Vec3b(210,210,210);
+        }
+
+        void on_path( const std::vector<cv::Point> &path )
+        {
+            for ( auto& p : path )
+                img.at<Vec3b>( p ) = Vec3b(0,0,255);
+        }
+
+    private:
+        cv::Mat img;
+        cv::Point start, goal;
+        bool draw_open;
+};
+
+// -----------------------------------------------------------------------
+
+class Counting_Search_Observer
+{
+    /*************************************************************
+     *  Statistics of the searches it has observed, accumulated
+     *  until reset() is called.
+     ************************************************************/
+    public:
+        long long expanded = 0;     // Nodes taken from the open list
+        long long opened = 0;       // Nodes put on the open list
+        long long path_length = 0;  // Pixels of all found paths
+        long long searches = 0;     // Searches that found a path
+
+        void on_expand( const cv::Point & ) { expanded++; }
+        void on_open( const cv::Point & ) { opened++; }
+        void on_path( const std::vector<cv::Point> &path )
+        {
+            path_length += path.size();
+            searches++;
+        }
+
+        void reset() { expanded = opened = path_length = searches = 0; }
+};
+
+#endif // SEARCH_OBSERVER_H
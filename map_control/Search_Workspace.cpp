@@ -0,0 +1,46 @@
+#include "Search_Workspace.h"
+
+#include <algorithm>
+
+// -----------------------------------------------------------------------
+
+Search_Workspace::Search_Workspace() {}
+
+// -----------------------------------------------------------------------
+
+Search_Workspace::~Search_Workspace() {}
+
+// -----------------------------------------------------------------------
+
+void Search_Workspace::resize( const size_t n )
+{
+    if ( seen.size() == n )
+        return;
+
+    generation = 0;
+    seen.assign( n, 0 );
+    closed.assign( n, 0 );
+    g.assign( n, 0 );
+    parent.assign( n, -1 );
+    route.reserve( n );
+    open_list.reserve( n );
+}
+
+// -----------------------------------------------------------------------
+
+void Search_Workspace::next_generation()
+{
+    generation++;
+    if ( generation == 0 ) // Wrapped around, old stamps could match again
+    {
+        std::fill( seen.begin(), seen.end(), 0 );
+        std::fill( closed.begin(), closed.end(), 0 );
+        generation = 1;
+    }
+}
+
+// -----------------------------------------------------------------------
+
+size_t Search_Workspace::size() const { return seen.size(); }
+
+// -----------------------------------------------------------------------
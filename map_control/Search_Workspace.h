@@ -0,0 +1,48 @@
+#ifndef SEARCH_WORKSPACE_H
+#define SEARCH_WORKSPACE_H
+
+#include <vector>
+
+#include "Open_List.h"
+
+using namespace std;
+
+class Search_Workspace
+{
+    /*************************************************************
+     *  Per query scratch space of a grid or graph search.
+     *
+     *  The roadmaps (Prepared_Roadmap, Roadmap_Graph) are immutable
+     *  after they are built, all state that changes during a search
+     *  lives here instead. Give every thread its own workspace and
+     *  any number of threads can search the same roadmap at once.
+     *
+     *  A cell is only valid when its stamp equals generation, so a
+     *  new query bumps the generation instead of clearing anything.
+     ************************************************************/
+    public:
+        Search_Workspace();
+
+        /**
+         * @brief resize -> Size the workspace for n cells or vertices,
+         *      does nothing if it already has that size
+         * @param n
+         */
+        void resize( const size_t n );
+
+        /**
+         * @brief next_generation -> Invalidate all cells for a new query
+         */
+        void next_generation();
+
+        size_t size() const;
+
+        unsigned int generation = 0;
+        std::vector<unsigned int> seen, closed;
+        std::vector<int> g, parent, route;
+        Index_Heap open_list;
+
+        ~Search_Workspace();
+};
+
+#endif // SEARCH_WORKSPACE_H
@@ -0,0 +1,428 @@
+#include "Segment_Voronoi.h"
+
+#include <boost/polygon/voronoi.hpp>
+#include <boost/polygon/polygon.hpp>
+
+#include <cmath>
+#include <map>
+
+typedef boost::polygon::point_data<int> Wall_Point;
+typedef boost::polygon::segment_data<int> Wall_Segment;
+typedef boost::polygon::voronoi_diagram<double> Diagram;
+
+// Pieces of a parabolic edge in the polyline
+static const int CURVE_SAMPLES = 8;
+
+// Keys of the vertex search, lengths in 1/1000 pixel
+static const double KEY_SCALE = 1000.0;
+
+// -----------------------------------------------------------------------
+
+static double distance_to_segment( const Point2d &q, const Point2d &a, const Point2d &b )
+{
+    double dx = b.x - a.x, dy = b.y - a.y;
+    double t = ( dx * dx + dy * dy > 0 ) ? ( ( q.x - a.x ) * dx + ( q.y - a.y ) * dy ) / ( dx * dx + dy * dy ) : 0;
+    t = max( 0.0, min( 1.0, t ) );
+    return hypot( q.x - ( a.x + t * dx ), q.y - ( a.y + t * dy ) );
+}
+
+// -----------------------------------------------------------------------
+
+static Point2d to_point( const Wall_Point &p ) { return Point2d( p.x(), p.y() ); }
+
+// -----------------------------------------------------------------------
+
+/*
+ *  The site of a Voronoi cell: a wall point, a segment end point or a
+ *  whole segment ( then a and b are its ends ). Points come first in
+ *  the source indices, then the segments.
+ */
+static bool cell_site( const Diagram::cell_type &cell,
+                       const std::vector<Wall_Point> &points,
+                       const std::vector<Wall_Segment> &segments,
+                       Point2d &a,
+                       Point2d &b )
+{
+    size_t index = cell.source_index();
+    if ( index < points.size() )
+    {
+        a = b = to_point( points[index] );
+        return false;
+    }
+
+    const Wall_Segment &s = segments[ index - points.size() ];
+    a = to_point( s.low() );
+    b = to_point( s.high() );
+    if ( cell.source_category() == boost::polygon::SOURCE_CATEGORY_SEGMENT_START_POINT )
+        b = a;
+    else if ( cell.source_category() == boost::polygon::SOURCE_CATEGORY_SEGMENT_END_POINT )
+        a = b;
+    return a != b;
+}
+
+// -----------------------------------------------------------------------
+
+Segment_Voronoi::Segment_Voronoi() {}
+
+// -----------------------------------------------------------------------
+
+Segment_Voronoi::Segment_Voronoi( const cv::Mat &floor_plan,
+                                  const double min_clearance,
+                                  const double epsilon )
+{
+    build( floor_plan, min_clearance, epsilon );
+}
+
+// -----------------------------------------------------------------------
+
+Segment_Voronoi::~Segment_Voronoi() {}
+
+// -----------------------------------------------------------------------
+
+void Segment_Voronoi::build( const cv::Mat &floor_plan,
+                             const double min_clearance,
+                             const double epsilon )
+{
+    Mat mask( floor_plan.rows, floor_plan.cols, CV_8UC1, Scalar(0) );
+    for (int y = 0; y < floor_plan.rows; y++)
+    {
+        const Vec3b *row = floor_plan.ptr<Vec3b>( y );
+        uchar *out = mask.ptr<uchar>( y );
+        for (int x = 0; x < floor_plan.cols; x++)
+            if ( row[x] == Vec3b(0,0,0) ) // If pixel black => wall
+                out[x] = 255;
+    }
+
+    // Outer boundaries and holes alike, every wall side is a segment
+    vector<vector<Point>> contours, polygons;
+    findContours( mask, contours, RETR_LIST, CHAIN_APPROX_SIMPLE );
+    for ( auto& contour : contours )
+    {
+        vector<Point> polygon;
+        approxPolyDP( contour, polygon, epsilon, true );
+        polygons.push_back( polygon );
+    }
+
+    build( polygons, floor_plan, min_clearance );
+}
+
+// -----------------------------------------------------------------------
+
+void Segment_Voronoi::build( const std::vector<std::vector<cv::Point>> &polygons,
+                             const cv::Mat &floor_plan,
+                             const double min_clearance )
+{
+    width = floor_plan.cols;
+    height = floor_plan.rows;
+    vertices.clear();
+    edges.clear();
+    walls.clear();
+
+    // Polygon sides, and a frame just outside the image so no edge runs off to infinity
+    std::vector<Wall_Segment> sides;
+    std::vector<Wall_Point> points;
+    for ( auto& polygon : polygons )
+    {
+        if ( polygon.size() == 1 )
+            points.push_back( Wall_Point( polygon[0].x, polygon[0].y ) );
+        for (size_t i = 0; polygon.size() > 1 && i < polygon.size(); i++)
+        {
+            const Point &a = polygon[i], &b = polygon[ ( i + 1 ) % polygon.size() ];
+            if ( a != b )
+                sides.push_back( Wall_Segment( Wall_Point( a.x, a.y ), Wall_Point( b.x, b.y ) ) );
+        }
+    }
+    Wall_Point corners[4] = { Wall_Point( -1, -1 ), Wall_Point( width, -1 ), Wall_Point( width, height ), Wall_Point( -1, height ) };
+    for (int i = 0; i < 4; i++)
+        sides.push_back( Wall_Segment( corners[i], corners[ ( i + 1 ) % 4 ] ) );
+
+    // The sweep line needs segments that only touch at their ends. Thin walls are traced
+    // along both sides, so overlaps are split into equal pieces and those kept once.
+    std::vector<Wall_Segment> pieces, segments;
+    boost::polygon::intersect_segments( pieces, sides.begin(), sides.end() );
+    std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> keys;
+    for ( auto& s : pieces )
+    {
+        std::pair<int, int> a( s.low().x(), s.low().y() ), b( s.high().x(), s.high().y() );
+        if ( a != b )
+            keys.push_back( a < b ? std::make_pair( a, b ) : std::make_pair( b, a ) );
+    }
+    sort( keys.begin(), keys.end() );
+    keys.erase( unique( keys.begin(), keys.end() ), keys.end() );
+    for ( auto& k : keys )
+    {
+        segments.push_back( Wall_Segment( Wall_Point( k.first.first, k.first.second ), Wall_Point( k.second.first, k.second.second ) ) );
+        walls.push_back( std::make_pair( Point( k.first.first, k.first.second ), Point( k.second.first, k.second.second ) ) );
+    }
+
+    // Single wall pixels on a segment are already part of it
+    std::vector<Wall_Point> sites;
+    for ( auto& p : points )
+    {
+        bool covered = false;
+        for (size_t i = 0; i < segments.size() && !covered; i++)
+        {
+            const Wall_Point &a = segments[i].low(), &b = segments[i].high();
+            long long cross = (long long)( b.x() - a.x() ) * ( p.y() - a.y() ) - (long long)( b.y() - a.y() ) * ( p.x() - a.x() );
+            covered = cross == 0 && p.x() >= min( a.x(), b.x() ) && p.x() <= max( a.x(), b.x() ) &&
+                                    p.y() >= min( a.y(), b.y() ) && p.y() <= max( a.y(), b.y() );
+        }
+        if ( !covered )
+            sites.push_back( p );
+    }
+    sort( sites.begin(), sites.end() );
+    sites.erase( unique( sites.begin(), sites.end() ), sites.end() );
+
+    Diagram diagram;
+    boost::polygon::construct_voronoi( sites.begin(), sites.end(), segments.begin(), segments.end(), &diagram );
+
+    auto is_free = [&]( const Point2d &p )
+    {
+        int x = (int)lround( p.x ), y = (int)lround( p.y );
+        return x >= 0 && y >= 0 && x < width && y < height && floor_plan.at<Vec3b>( y, x ) != Vec3b(0,0,0);
+    };
+
+    // Kept edges of the diagram, between its own vertices
+    std::map<const Diagram::vertex_type*, int> node_of;
+    std::vector<Point2d> nodes;
+    std::vector<double> node_clearance;
+    std::vector<Segment_Edge> pieces_kept;
+    for ( auto& edge : diagram.edges() )
+    {
+        if ( !edge.is_primary() || !edge.is_finite() || &edge > edge.twin() ) // Each edge once
+            continue;
+
+        Point2d start( edge.vertex0()->x(), edge.vertex0()->y() ), end( edge.vertex1()->x(), edge.vertex1()->y() );
+        Point2d a0, b0, a1, b1;
+        bool segment0 = cell_site( *edge.cell(), sites, segments, a0, b0 );
+        bool segment1 = cell_site( *edge.twin()->cell(), sites, segments, a1, b1 );
+
+        Segment_Edge piece;
+        piece.points.push_back( start );
+        double clearance = min( distance_to_segment( start, a0, b0 ), distance_to_segment( end, a0, b0 ) );
+        if ( edge.is_curved() )
+        {
+            // Parabola between a point and a segment, in a frame with the x axis along the segment
+            Point2d focus = segment0 ? a1 : a0, a = segment0 ? a0 : a1, b = segment0 ? b0 : b1;
+            double length = hypot( b.x - a.x, b.y - a.y );
+            Point2d u( ( b.x - a.x ) / length, ( b.y - a.y ) / length ), n( -u.y, u.x );
+            auto local_x = [&]( const Point2d &p ) { return ( p.x - a.x ) * u.x + ( p.y - a.y ) * u.y; };
+            double fx = local_x( focus ), fy = ( focus.x - a.x ) * n.x + ( focus.y - a.y ) * n.y;
+            double x0 = local_x( start ), x1 = local_x( end );
+            for (int i = 1; i < CURVE_SAMPLES; i++)
+            {
+                double x = x0 + ( x1 - x0 ) * i / CURVE_SAMPLES;
+                double y = ( ( x - fx ) * ( x - fx ) + fy * fy ) / ( 2 * fy );
+                piece.points.push_back( Point2d( a.x + u.x * x + n.x * y, a.y + u.y * x + n.y * y ) );
+            }
+            if ( ( fx - x0 ) * ( fx - x1 ) < 0 ) // The apex is closest to the point
+                clearance = min( clearance, fabs( fy ) / 2 );
+        }
+        else if ( !segment0 && !segment1 )
+        {
+            // Between two points the middle of them is closest
+            Point2d middle( ( a0.x + a1.x ) / 2, ( a0.y + a1.y ) / 2 );
+            if ( distance_to_segment( middle, start, end ) < 1e-9 )
+                clearance = min( clearance, hypot( a0.x - a1.x, a0.y - a1.y ) / 2 );
+        }
+        piece.points.push_back( end );
+
+        bool inside = clearance >= min_clearance;
+        for (size_t i = 0; i < piece.points.size() && inside; i++)
+            inside = is_free( piece.points[i] );
+        if ( !inside )
+            continue;
+
+        const Diagram::vertex_type *ends[2] = { edge.vertex0(), edge.vertex1() };
+        int ids[2];
+        for (int k = 0; k < 2; k++)
+        {
+            auto found = node_of.find( ends[k] );
+            if ( found == node_of.end() )
+            {
+                Point2d p( ends[k]->x(), ends[k]->y() );
+                found = node_of.insert( std::make_pair( ends[k], (int)nodes.size() ) ).first;
+                nodes.push_back( p );
+                node_clearance.push_back( distance_to_segment( p, a0, b0 ) );
+            }
+            ids[k] = found->second;
+        }
+        piece.from = ids[0];
+        piece.to = ids[1];
+        piece.clearance = clearance;
+        for (size_t i = 1; i < piece.points.size(); i++)
+            piece.length += hypot( piece.points[i].x - piece.points[i-1].x, piece.points[i].y - piece.points[i-1].y );
+        pieces_kept.push_back( piece );
+    }
+
+    // Join chains through nodes of degree 2, the other nodes become vertices
+    std::vector<std::vector<int>> touching( nodes.size() );
+    for (size_t i = 0; i < pieces_kept.size(); i++)
+    {
+        touching[ pieces_kept[i].from ].push_back( (int)i );
+        touching[ pieces_kept[i].to ].push_back( (int)i );
+    }
+    std::vector<int> vertex_of( nodes.size(), -1 );
+    auto add_vertex = [&]( const int node )
+    {
+        vertex_of[node] = (int)vertices.size();
+        Segment_Vertex v;
+        v.point = nodes[node];
+        v.clearance = node_clearance[node];
+        vertices.push_back( v );
+    };
+    for (size_t node = 0; node < nodes.size(); node++)
+        if ( touching[node].size() != 2 )
+            add_vertex( (int)node );
+
+    std::vector<bool> used( pieces_kept.size(), false );
+    auto walk = [&]( const int first, const int first_piece )
+    {
+        Segment_Edge edge;
+        edge.from = vertex_of[first];
+        edge.clearance = HUGE_VAL;
+        edge.points.push_back( nodes[first] );
+        for (int node = first, p = first_piece; ; )
+        {
+            used[p] = true;
+            const Segment_Edge &piece = pieces_kept[p];
+            bool forward = ( piece.from == node );
+            if ( forward )
+                edge.points.insert( edge.points.end(), piece.points.begin() + 1, piece.points.end() );
+            else
+                edge.points.insert( edge.points.end(), piece.points.rbegin() + 1, piece.points.rend() );
+            edge.length += piece.length;
+            edge.clearance = min( edge.clearance, piece.clearance );
+
+            node = forward ? piece.to : piece.from;
+            if ( vertex_of[node] >= 0 )
+            {
+                edge.to = vertex_of[node];
+                break;
+            }
+            p = ( touching[node][0] == p ) ? touching[node][1] : touching[node][0];
+        }
+        vertices[ edge.from ].edges.push_back( (int)edges.size() );
+        if ( edge.to != edge.from )
+            vertices[ edge.to ].edges.push_back( (int)edges.size() );
+        edges.push_back( edge );
+    };
+    for (size_t node = 0; node < nodes.size(); node++)
+        if ( vertex_of[node] >= 0 )
+            for ( auto& p : touching[node] )
+                if ( !used[p] )
+                    walk( (int)node, p );
+
+    // Closed loops without a junction get one artificial vertex
+    for (size_t p = 0; p < pieces_kept.size(); p++)
+        if ( !used[p] )
+        {
+            add_vertex( pieces_kept[p].from );
+            walk( pieces_kept[p].from, (int)p );
+        }
+
+    g.assign( vertices.size(), HUGE_VAL );
+    parent_edge.assign( vertices.size(), -1 );
+    open_list.reserve( vertices.size() );
+}
+
+// -----------------------------------------------------------------------
+
+bool Segment_Voronoi::find_path( const int from, const int to, std::vector<cv::Point2d> &path )
+{
+    path.clear();
+    if ( from < 0 || to < 0 || from >= (int)vertices.size() || to >= (int)vertices.size() )
+        return false;
+
+    std::fill( g.begin(), g.end(), HUGE_VAL );
+    open_list.clear();
+    g[from] = 0;
+    parent_edge[from] = -1;
+    open_list.push( from, 0 );
+    while ( !open_list.empty() )
+    {
+        int v = open_list.pop();
+        if ( v == to )
+            break;
+
+        for ( auto& e : vertices[v].edges )
+        {
+            int w = ( edges[e].from == v ) ? edges[e].to : edges[e].from;
+            if ( g[v] + edges[e].length < g[w] )
+            {
+                g[w] = g[v] + edges[e].length;
+                parent_edge[w] = e;
+                open_list.push( w, (long long)( g[w] * KEY_SCALE ) );
+            }
+        }
+    }
+    if ( g[to] == HUGE_VAL ) // Havent found goal
+        return false;
+
+    // Polylines from the goal back to the start, then reversed
+    path.push_back( vertices[to].point );
+    for (int v = to; v != from; )
+    {
+        const Segment_Edge &edge = edges[ parent_edge[v] ];
+        if ( edge.to == v )
+            path.insert( path.end(), edge.points.rbegin() + 1, edge.points.rend() );
+        else
+            path.insert( path.end(), edge.points.begin() + 1, edge.points.end() );
+        v = ( edge.to == v ) ? edge.from : edge.to;
+    }
+    reverse( path.begin(), path.end() );
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+int Segment_Voronoi::nearest_vertex( const cv::Point2d &p ) const
+{
+    int best = -1;
+    double best_distance = HUGE_VAL;
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        double d = hypot( vertices[i].point.x - p.x, vertices[i].point.y - p.y );
+        if ( d < best_distance )
+        {
+            best_distance = d;
+            best = (int)i;
+        }
+    }
+    return best;
+}
+
+// -----------------------------------------------------------------------
+
+cv::Mat Segment_Voronoi::draw_roadmap( const cv::Mat &img ) const
+{
+    Mat result = img.clone();
+    double sx = width > 0 ? (double)img.cols / width : 1, sy = height > 0 ? (double)img.rows / height : 1;
+    auto scaled = [&]( const Point2d &p ) { return Point( (int)lround( ( p.x + 0.5 ) * sx - 0.5 ), (int)lround( ( p.y + 0.5 ) * sy - 0.5 ) ); };
+    for ( auto& edge : edges )
+        for (size_t i = 1; i < edge.points.size(); i++)
+            line( result, scaled( edge.points[i-1] ), scaled( edge.points[i] ), Scalar(0,0,255), 1, 8, 0 );
+    return result;
+}
+
+// -----------------------------------------------------------------------
+
+const std::vector<Segment_Vertex> &Segment_Voronoi::get_vertices() const { return vertices; }
+
+// -----------------------------------------------------------------------
+
+const std::vector<Segment_Edge> &Segment_Voronoi::get_edges() const { return edges; }
+
+// -----------------------------------------------------------------------
+
+const std::vector<std::pair<cv::Point, cv::Point>> &Segment_Voronoi::get_walls() const { return walls; }
+
+// -----------------------------------------------------------------------
+
+int Segment_Voronoi::get_width() const { return width; }
+
+// -----------------------------------------------------------------------
+
+int Segment_Voronoi::get_height() const { return height; }
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,130 @@
+#ifndef SEGMENT_VORONOI_H
+#define SEGMENT_VORONOI_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+#include "opencv2/imgproc.hpp"
+
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "Open_List.h"
+
+using namespace std;
+using namespace cv;
+
+struct Segment_Vertex
+{
+    Point2d point;
+    double clearance = 0;   // Distance to the nearest wall in pixels
+    vector<int> edges;      // Ids of the edges touching this vertex
+};
+
+struct Segment_Edge
+{
+    int from = -1, to = -1;
+    vector<Point2d> points; // Polyline from "from" to "to", both included, curved parts sampled
+    double length = 0;      // Length of the polyline in pixels
+    double clearance = 0;   // Smallest distance to a wall along the edge
+};
+
+class Segment_Voronoi
+{
+    /*************************************************************
+     *  Voronoi roadmap of the wall polygons instead of the pixels.
+     *
+     *  The walls are traced once with findContours and simplified
+     *  with approxPolyDP. The Voronoi diagram of the resulting line
+     *  segments comes from the sweep line of Boost.Polygon, so its
+     *  cost depends on the number of wall segments only: a plan
+     *  upscaled 10x has the same segments and the same diagram.
+     *
+     *  Edges of the diagram inside walls, outside the image or with
+     *  less clearance than min_clearance somewhere along them are
+     *  dropped, the branches into wall corners go with them. Chains
+     *  of edges through vertices of degree 2 are joined, so the graph
+     *  has the junctions and dead ends as vertices, like Roadmap_Graph,
+     *  but with exact coordinates. Edges between a wall corner and a
+     *  wall are parabolas, their polyline is sampled.
+     ************************************************************/
+    public:
+        Segment_Voronoi();
+
+        /**
+         * @brief Segment_Voronoi
+         * @param floor_plan => BGR image, black pixels are walls
+         * @param min_clearance => Edges that come closer to a wall are dropped, pixels
+         * @param epsilon => approxPolyDP tolerance of the wall polygons, pixels
+         */
+        Segment_Voronoi( const cv::Mat &floor_plan,
+                         const double min_clearance = 1.0,
+                         const double epsilon = 1.0 );
+
+        /**
+         * @brief build -> Trace the walls and build the roadmap graph
+         * @param floor_plan
+         * @param min_clearance
+         * @param epsilon
+         */
+        void build( const cv::Mat &floor_plan,
+                    const double min_clearance = 1.0,
+                    const double epsilon = 1.0 );
+
+        /**
+         * @brief build -> Roadmap graph of given wall polygons
+         * @param polygons => Closed polygons through the wall pixels, e.g.
+         *      from approxPolyDP, a single point is a wall pixel on its own
+         * @param floor_plan => Used to drop the edges inside walls
+         * @param min_clearance
+         */
+        void build( const std::vector<std::vector<cv::Point>> &polygons,
+                    const cv::Mat &floor_plan,
+                    const double min_clearance = 1.0 );
+
+        /**
+         * @brief find_path -> Shortest path between two vertices
+         * @param from
+         * @param to
+         * @param path => Cleared and filled with the polyline from "from"
+         *      to "to", both included
+         * @return true if a path was found
+         */
+        bool find_path( const int from, const int to, std::vector<cv::Point2d> &path );
+
+        /**
+         * @brief nearest_vertex
+         * @param p
+         * @return Id of the vertex closest to p, -1 if the graph is empty
+         */
+        int nearest_vertex( const cv::Point2d &p ) const;
+
+        /**
+         * @brief draw_roadmap -> Edges as red lines on a copy of img, scaled
+         *      when img has another resolution than the plan of build()
+         * @param img
+         * @return
+         */
+        cv::Mat draw_roadmap( const cv::Mat &img ) const;
+
+        const std::vector<Segment_Vertex> &get_vertices() const;
+        const std::vector<Segment_Edge> &get_edges() const;
+        const std::vector<std::pair<cv::Point, cv::Point>> &get_walls() const;     // Segments after splitting at crossings
+        int get_width() const;
+        int get_height() const;
+
+        ~Segment_Voronoi();
+
+    private:
+        int width = 0, height = 0;
+        std::vector<Segment_Vertex> vertices;
+        std::vector<Segment_Edge> edges;
+        std::vector<std::pair<cv::Point, cv::Point>> walls;
+
+        // Dijkstra over the vertices
+        std::vector<double> g;
+        std::vector<int> parent_edge;
+        Index_Heap open_list;
+};
+
+#endif // SEGMENT_VORONOI_H
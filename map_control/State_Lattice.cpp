@@ -0,0 +1,433 @@
+#include "State_Lattice.h"
+#include "A_Star.h"
+#include "Thread_Pool.h"
+
+#include <cmath>
+
+// Direction of every lattice heading, counter clockwise in x, y ( clockwise on screen, y is down )
+static const int DIRECTION_X[LATTICE_HEADINGS] = { 1, 2, 1, 1, 0, -1, -1, -2, -1, -2, -1, -1,  0,  1,  1,  2 };
+static const int DIRECTION_Y[LATTICE_HEADINGS] = { 0, 1, 1, 2, 1,  2,  1,  1,  0, -1, -1, -2, -1, -2, -1, -1 };
+
+// Steps of the curve tables, fine enough that no swept cell is missed
+static const int CURVE_STEPS = 256;
+
+// Largest time between two trajectory points
+static const double SAMPLE_TIME = 0.1;
+
+// Octile over Euclidean length at most, scales the field distance down to a lower bound
+static const double OCTILE_OVERESTIMATE = 1.0824;
+
+// -----------------------------------------------------------------------
+
+static double wrap_angle( double angle )
+{
+    while ( angle > M_PI )
+        angle -= 2 * M_PI;
+    while ( angle <= -M_PI )
+        angle += 2 * M_PI;
+    return angle;
+}
+
+// -----------------------------------------------------------------------
+
+State_Lattice::State_Lattice( const Lattice_Robot &robot ) : robot( robot )
+{
+    primitives.resize( LATTICE_HEADINGS );
+    for (int k = 0; k < LATTICE_HEADINGS; k++)
+    {
+        Point direction( DIRECTION_X[k], DIRECTION_Y[k] );
+        double step = cv::norm( direction );
+        int repeat = max( 2, (int)lround( robot.straight_length / step ) );
+        add_curve( k, direction, k );
+        add_curve( k, direction * repeat, k );
+
+        // Arcs of constant curvature, the end rounded to the nearest cell
+        for ( int turn : { -2, -1, 1, 2 } )
+        {
+            int end_heading = ( k + turn + LATTICE_HEADINGS ) % LATTICE_HEADINGS;
+            double delta = wrap_angle( theta_of( end_heading ) - theta_of( k ) );
+            double length = robot.arc_length * ( abs( turn ) == 2 ? 1.5 : 1.0 );
+            double r = length / delta;
+            Point end( (int)lround( r * ( sin( theta_of( end_heading ) ) - sin( theta_of( k ) ) ) ),
+                       (int)lround( -r * ( cos( theta_of( end_heading ) ) - cos( theta_of( k ) ) ) ) );
+            if ( end != Point( 0, 0 ) )
+                add_curve( k, end, end_heading );
+        }
+
+        add_turn( k, ( k + 1 ) % LATTICE_HEADINGS );
+        add_turn( k, ( k + LATTICE_HEADINGS - 1 ) % LATTICE_HEADINGS );
+    }
+}
+
+// -----------------------------------------------------------------------
+
+State_Lattice::~State_Lattice() {}
+
+// -----------------------------------------------------------------------
+
+void State_Lattice::add_curve( const int heading, const cv::Point &end, const int end_heading )
+{
+    // Cubic Hermite curve from ( 0, 0, heading ) to ( end, end_heading ), tangents as long as the chord
+    double chord = cv::norm( end );
+    double t0x = chord * cos( theta_of( heading ) ), t0y = chord * sin( theta_of( heading ) );
+    double t1x = chord * cos( theta_of( end_heading ) ), t1y = chord * sin( theta_of( end_heading ) );
+    auto position = [&]( const double u, double &x, double &y )
+    {
+        double h10 = u * u * u - 2 * u * u + u, h01 = -2 * u * u * u + 3 * u * u, h11 = u * u * u - u * u;
+        x = h10 * t0x + h01 * end.x + h11 * t1x;
+        y = h10 * t0y + h01 * end.y + h11 * t1y;
+    };
+    auto tangent = [&]( const double u )
+    {
+        double d10 = 3 * u * u - 4 * u + 1, d01 = -6 * u * u + 6 * u, d11 = 3 * u * u - 2 * u;
+        return atan2( d10 * t0y + d01 * end.y + d11 * t1y, d10 * t0x + d01 * end.x + d11 * t1x );
+    };
+
+    // Arc length and heading along the curve
+    std::vector<double> s( CURVE_STEPS + 1, 0 ), xs( CURVE_STEPS + 1 ), ys( CURVE_STEPS + 1 ), thetas( CURVE_STEPS + 1 );
+    double curvature = 0;
+    for (int i = 0; i <= CURVE_STEPS; i++)
+    {
+        double u = (double)i / CURVE_STEPS;
+        position( u, xs[i], ys[i] );
+        thetas[i] = tangent( u );
+        if ( i > 0 )
+        {
+            double ds = hypot( xs[i] - xs[i-1], ys[i] - ys[i-1] );
+            s[i] = s[i-1] + ds;
+            if ( ds > 0 )
+                curvature = max( curvature, fabs( wrap_angle( thetas[i] - thetas[i-1] ) ) / ds );
+        }
+    }
+
+    // Constant speed, slow enough that the sharpest bend stays within the turn rate
+    Motion_Primitive primitive;
+    primitive.start_heading = heading;
+    primitive.end_heading = end_heading;
+    primitive.end = end;
+    double total = s[CURVE_STEPS];
+    double v = robot.speed;
+    if ( curvature * v > robot.turn_rate )
+        v = robot.turn_rate / curvature;
+    primitive.duration = total / v;
+    primitive.cost = (int)lround( primitive.duration * 1000 );
+
+    int segments = max( 1, (int)ceil( primitive.duration / SAMPLE_TIME ) );
+    for (int i = 0, j = 0; i <= segments; i++)
+    {
+        double target = total * i / segments;
+        while ( j < CURVE_STEPS && s[j+1] < target )
+            j++;
+        double f = ( j < CURVE_STEPS && s[j+1] > s[j] ) ? ( target - s[j] ) / ( s[j+1] - s[j] ) : 0;
+        int k = min( j + 1, CURVE_STEPS );
+
+        Trajectory_Point p;
+        p.x = xs[j] + f * ( xs[k] - xs[j] );
+        p.y = ys[j] + f * ( ys[k] - ys[j] );
+        p.theta = thetas[j] + f * wrap_angle( thetas[k] - thetas[j] );
+        p.t = primitive.duration * i / segments;
+        p.v = v;
+        primitive.samples.push_back( p );
+    }
+    primitive.samples.front().theta = theta_of( heading ); // Exact lattice headings at both ends
+    primitive.samples.back().theta = theta_of( end_heading );
+    for (size_t i = 0; i + 1 < primitive.samples.size(); i++)
+    {
+        Trajectory_Point &a = primitive.samples[i], &b = primitive.samples[i+1];
+        a.omega = wrap_angle( b.theta - a.theta ) / ( b.t - a.t );
+    }
+    if ( primitive.samples.size() > 1 )
+        primitive.samples.back().omega = primitive.samples[ primitive.samples.size() - 2 ].omega;
+
+    // The robot sweeps its footprint along the fine curve
+    for (int i = 0; i <= CURVE_STEPS; i++)
+    {
+        Trajectory_Point p;
+        p.x = xs[i];
+        p.y = ys[i];
+        Motion_Primitive point;
+        point.samples.push_back( p );
+        add_footprint( point );
+        primitive.footprint.insert( primitive.footprint.end(), point.footprint.begin(), point.footprint.end() );
+    }
+    std::sort( primitive.footprint.begin(), primitive.footprint.end(),
+               []( const Point &a, const Point &b ) { return a.y < b.y || ( a.y == b.y && a.x < b.x ); } );
+    primitive.footprint.erase( std::unique( primitive.footprint.begin(), primitive.footprint.end() ), primitive.footprint.end() );
+
+    primitives[heading].push_back( primitive );
+}
+
+// -----------------------------------------------------------------------
+
+void State_Lattice::add_turn( const int heading, const int end_heading )
+{
+    // Stop and turn on the spot, only worth it where no curve fits
+    Motion_Primitive primitive;
+    primitive.start_heading = heading;
+    primitive.end_heading = end_heading;
+    primitive.turn_in_place = true;
+    double delta = wrap_angle( theta_of( end_heading ) - theta_of( heading ) );
+    primitive.duration = fabs( delta ) / robot.turn_rate;
+    primitive.cost = (int)lround( primitive.duration * 1000 * robot.turn_penalty );
+
+    int segments = max( 1, (int)ceil( primitive.duration / SAMPLE_TIME ) );
+    for (int i = 0; i <= segments; i++)
+    {
+        Trajectory_Point p;
+        p.theta = wrap_angle( theta_of( heading ) + delta * i / segments );
+        p.t = primitive.duration * i / segments;
+        p.omega = ( delta > 0 ) ? robot.turn_rate : -robot.turn_rate;
+        primitive.samples.push_back( p );
+    }
+    add_footprint( primitive );
+
+    primitives[heading].push_back( primitive );
+}
+
+// -----------------------------------------------------------------------
+
+void State_Lattice::add_footprint( Motion_Primitive &primitive ) const
+{
+    // Every cell whose square is within the radius of a sample
+    for ( auto& p : primitive.samples )
+    {
+        int reach = (int)ceil( robot.radius + 0.5 );
+        for (int cy = (int)floor( p.y ) - reach; cy <= (int)ceil( p.y ) + reach; cy++)
+            for (int cx = (int)floor( p.x ) - reach; cx <= (int)ceil( p.x ) + reach; cx++)
+            {
+                double dx = max( fabs( p.x - cx ) - 0.5, 0.0 );
+                double dy = max( fabs( p.y - cy ) - 0.5, 0.0 );
+                if ( dx * dx + dy * dy <= robot.radius * robot.radius &&
+                     std::find( primitive.footprint.begin(), primitive.footprint.end(), Point( cx, cy ) ) == primitive.footprint.end() )
+                    primitive.footprint.push_back( Point( cx, cy ) );
+            }
+    }
+}
+
+// -----------------------------------------------------------------------
+
+void State_Lattice::set_map( const cv::Mat &floor_plan )
+{
+    this->floor_plan = floor_plan.clone();
+    width = floor_plan.cols;
+    height = floor_plan.rows;
+
+    blocked.assign( (size_t)width * height, false );
+    for (int y = 0; y < height; y++)
+    {
+        const Vec3b *row = floor_plan.ptr<Vec3b>( y );
+        for (int x = 0; x < width; x++)
+            if ( row[x] == Vec3b(0,0,0) ) // If pixel black => obstacle
+                blocked.set( (size_t)y * width + x );
+    }
+
+    size_t states = (size_t)width * height * LATTICE_HEADINGS;
+    generation = 0;
+    stamp.assign( states, 0 );
+    g.resize( states );
+    parent.resize( states );
+    parent_primitive.resize( states );
+    open_list.reserve( states );
+    field_ready = false; // Built on the old map
+}
+
+// -----------------------------------------------------------------------
+
+void State_Lattice::next_generation()
+{
+    generation += 2; // generation = open, generation + 1 = closed
+    if ( generation < 2 ) // Wrapped around, old stamps could match again
+    {
+        std::fill( stamp.begin(), stamp.end(), 0 );
+        generation = 2;
+    }
+}
+
+// -----------------------------------------------------------------------
+
+bool State_Lattice::collides( const cv::Point &cell, const Motion_Primitive &primitive ) const
+{
+    for ( auto& offset : primitive.footprint )
+    {
+        int x = cell.x + offset.x, y = cell.y + offset.y;
+        if ( x < 0 || y < 0 || x >= width || y >= height || blocked.test( (size_t)y * width + x ) )
+            return true;
+    }
+    return false;
+}
+
+// -----------------------------------------------------------------------
+
+bool State_Lattice::plan( const cv::Point &start,
+                          const double start_theta,
+                          const cv::Point &goal,
+                          std::vector<Trajectory_Point> &trajectory,
+                          const int goal_heading )
+{
+    if ( !default_pool )
+        default_pool.reset( new Thread_Pool() );
+    return plan( start, start_theta, goal, trajectory, *default_pool, goal_heading );
+}
+
+// -----------------------------------------------------------------------
+
+bool State_Lattice::plan( const cv::Point &start,
+                          const double start_theta,
+                          const cv::Point &goal,
+                          std::vector<Trajectory_Point> &trajectory,
+                          Thread_Pool &pool,
+                          const int goal_heading )
+{
+    trajectory.clear();
+    expansions = 0;
+    auto outside = [&]( const Point &p ) { return p.x < 0 || p.y < 0 || p.x >= width || p.y >= height; };
+    if ( outside( start ) || outside( goal ) ||
+         blocked.test( (size_t)start.y * width + start.x ) || blocked.test( (size_t)goal.y * width + goal.x ) )
+        return false;
+
+    // Time to the goal along the grid, never more than along the lattice
+    if ( !field_ready || field.get_goal() != goal )
+    {
+        field.build( floor_plan, goal, true, pool );
+        field_ready = true;
+    }
+    const double ms_per_cost = 1000.0 / ( G_DIRECT * robot.speed * OCTILE_OVERESTIMATE );
+    auto heuristic = [&]( const Point &p ) -> long long
+    {
+        int d = field.distance( p );
+        return ( d == Navigation_Field::UNREACHABLE ) ? -1 : (long long)( d * ms_per_cost );
+    };
+    if ( heuristic( start ) < 0 ) // Cut off from the goal
+        return false;
+
+    next_generation();
+    open_list.clear();
+
+    int first = ( start.y * width + start.x ) * LATTICE_HEADINGS + heading_of( start_theta );
+    int found = -1;
+    stamp[first] = generation;
+    g[first] = 0;
+    parent[first] = -1;
+    open_list.push( first, heuristic( start ) );
+
+    while ( !open_list.empty() )
+    {
+        int id = open_list.pop();
+        stamp[id] = generation + 1; // Closed
+        expansions++;
+
+        int heading = id % LATTICE_HEADINGS, cell = id / LATTICE_HEADINGS;
+        Point p( cell % width, cell / width );
+        if ( p == goal && ( goal_heading < 0 || heading == goal_heading ) )
+        {
+            found = id;
+            break;
+        }
+
+        const std::vector<Motion_Primitive> &moves = primitives[heading];
+        for (size_t j = 0; j < moves.size(); j++)
+        {
+            Point q = p + moves[j].end;
+            if ( outside( q ) || collides( p, moves[j] ) )
+                continue;
+
+            int next = ( q.y * width + q.x ) * LATTICE_HEADINGS + moves[j].end_heading;
+            long long h = heuristic( q );
+            if ( stamp[next] == generation + 1 || h < 0 )
+                continue;
+
+            int new_g = g[id] + moves[j].cost;
+            if ( stamp[next] != generation || new_g < g[next] )
+            {
+                stamp[next] = generation;
+                g[next] = new_g;
+                parent[next] = id;
+                parent_primitive[next] = (uchar)j;
+                open_list.push( next, new_g + h );
+            }
+        }
+    }
+
+    if ( found < 0 ) // Havent found goal
+        return false;
+
+    // Primitives from the start, then their samples moved to the cells and times they start at
+    std::vector<int> route;
+    for (int id = found; id != first; id = parent[id])
+        route.push_back( id );
+    reverse( route.begin(), route.end() );
+
+    Trajectory_Point begin;
+    begin.x = start.x;
+    begin.y = start.y;
+    begin.theta = theta_of( heading_of( start_theta ) );
+    trajectory.push_back( begin );
+
+    double t = 0;
+    for ( auto& id : route )
+    {
+        int from = parent[id];
+        const Motion_Primitive &move = primitives[ from % LATTICE_HEADINGS ][ parent_primitive[id] ];
+        int cell = from / LATTICE_HEADINGS;
+        trajectory.back().v = move.samples.front().v;
+        trajectory.back().omega = move.samples.front().omega;
+        for (size_t i = 1; i < move.samples.size(); i++)
+        {
+            Trajectory_Point p = move.samples[i];
+            p.x += cell % width;
+            p.y += cell / width;
+            p.t += t;
+            trajectory.push_back( p );
+        }
+        t += move.duration;
+    }
+    trajectory.back().v = 0; // Stop at the goal
+    trajectory.back().omega = 0;
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+int State_Lattice::heading_of( const double theta )
+{
+    int best = 0;
+    for (int k = 1; k < LATTICE_HEADINGS; k++)
+        if ( fabs( wrap_angle( theta - theta_of( k ) ) ) < fabs( wrap_angle( theta - theta_of( best ) ) ) )
+            best = k;
+    return best;
+}
+
+// -----------------------------------------------------------------------
+
+double State_Lattice::theta_of( const int heading )
+{
+    return atan2( (double)DIRECTION_Y[heading], (double)DIRECTION_X[heading] );
+}
+
+// -----------------------------------------------------------------------
+
+cv::Mat State_Lattice::draw( const cv::Mat &img, const std::vector<Trajectory_Point> &trajectory )
+{
+    Mat result = img.clone();
+    for ( auto& p : trajectory )
+    {
+        Point cell( (int)lround( p.x ), (int)lround( p.y ) );
+        if ( cell.x >= 0 && cell.y >= 0 && cell.x < result.cols && cell.y < result.rows )
+            result.at<Vec3b>( cell ) = ( p.v == 0 && p.omega != 0 ) ? Vec3b(255,0,0) : Vec3b(0,0,255);
+    }
+    return result;
+}
+
+// -----------------------------------------------------------------------
+
+const std::vector<Motion_Primitive> &State_Lattice::get_primitives( const int heading ) const { return primitives[heading]; }
+
+// -----------------------------------------------------------------------
+
+const Lattice_Robot &State_Lattice::get_robot() const { return robot; }
+
+// -----------------------------------------------------------------------
+
+int State_Lattice::get_expansions() const { return expansions; }
+
+// -----------------------------------------------------------------------
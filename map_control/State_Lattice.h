@@ -0,0 +1,179 @@
+#ifndef STATE_LATTICE_H
+#define STATE_LATTICE_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/core.hpp>
+
+#include <iostream>
+#include <vector>
+#include <memory>
+
+#include "Open_List.h"
+#include "Bit_Plane.h"
+#include "Navigation_Field.h"
+
+using namespace std;
+using namespace cv;
+
+const int LATTICE_HEADINGS = 16;   // Directions of (1,0), (2,1), (1,1), (1,2), (0,1), ...
+
+struct Lattice_Robot
+{
+    /*************************************************************
+     *  Robot limits in map units ( pixels ), defaults for the
+     *  pioneer2dx on the big floor plans.
+     ************************************************************/
+    double radius = 0.3;            // Footprint radius in pixels
+    double speed = 1.0;             // Forward speed in pixels per second
+    double turn_rate = 1.0;         // Largest turn rate in rad/s
+    double straight_length = 4.0;   // Length of the long straight primitive in pixels
+    double arc_length = 3.0;        // Length of the turning primitives in pixels
+    double turn_penalty = 4.0;      // Cost factor of turning on the spot, it stops the robot
+};
+
+struct Trajectory_Point
+{
+    double x = 0, y = 0;            // Pixels
+    double theta = 0;               // Image frame ( y down ), radians
+    double t = 0;                   // Seconds since the start
+    double v = 0;                   // Forward speed, pixels per second
+    double omega = 0;               // Turn rate, rad/s
+};
+
+struct Motion_Primitive
+{
+    int start_heading = 0, end_heading = 0;
+    cv::Point end;                          // Cell offset of the end pose
+    int cost = 0;                           // Milliseconds, turning on the spot scaled by turn_penalty
+    double duration = 0;                    // Seconds
+    bool turn_in_place = false;
+    std::vector<cv::Point> footprint;       // Cells swept by the robot, offsets from the start cell
+    std::vector<Trajectory_Point> samples;  // Relative to the start cell, t from 0 to duration
+};
+
+class State_Lattice
+{
+    /*************************************************************
+     *  Planner over ( x, y, heading ) for a differential drive robot.
+     *
+     *  Every heading has a few motion primitives: a short and a long
+     *  straight move, arcs of one and two heading steps to both sides
+     *  and, as a last resort, a turn on the spot. The arcs are cubic
+     *  Hermite curves that start and end exactly on a cell with the
+     *  lattice heading, so consecutive primitives join smoothly and
+     *  the robot keeps moving.
+     *
+     *  The primitives and the cells they sweep with the footprint of
+     *  the robot are generated once in the constructor. Collision
+     *  checking in the search is a walk over that table.
+     *
+     *  The search is A* on time, the heuristic is the goal distance
+     *  of a Navigation_Field divided by the speed. The field is kept
+     *  until the goal changes, so queries to one goal share it, and
+     *  the search arrays are reset with generation stamps like
+     *  Search_Workspace instead of a pass over all states. The path comes back
+     *  as time stamped poses with speed and turn rate, ready for the
+     *  controller to follow.
+     ************************************************************/
+    public:
+        /**
+         * @brief State_Lattice -> Generate the primitive tables
+         * @param robot
+         */
+        State_Lattice( const Lattice_Robot &robot = Lattice_Robot() );
+
+        /**
+         * @brief set_map -> Load which cells are blocked
+         * @param floor_plan => BGR image, black pixels are obstacles
+         */
+        void set_map( const cv::Mat &floor_plan );
+
+        /**
+         * @brief plan -> Search a trajectory from the start pose to the goal
+         * @param start => Free pixel
+         * @param start_theta => Heading at the start, rounded to the lattice
+         * @param goal => Free pixel
+         * @param trajectory => Cleared and filled with the poses from
+         *      start to goal, at most 0.1 s apart
+         * @param goal_heading => Lattice heading at the goal, -1 = any
+         * @return true if a trajectory was found
+         */
+        bool plan( const cv::Point &start,
+                   const double start_theta,
+                   const cv::Point &goal,
+                   std::vector<Trajectory_Point> &trajectory,
+                   const int goal_heading = -1 );
+
+        /**
+         * @brief plan -> As above, a new goal field is built on the
+         *      threads of pool instead of a pool owned by the lattice
+         */
+        bool plan( const cv::Point &start,
+                   const double start_theta,
+                   const cv::Point &goal,
+                   std::vector<Trajectory_Point> &trajectory,
+                   Thread_Pool &pool,
+                   const int goal_heading = -1 );
+
+        /**
+         * @brief heading_of
+         * @param theta => Radians, image frame
+         * @return Nearest lattice heading
+         */
+        static int heading_of( const double theta );
+
+        /**
+         * @brief theta_of
+         * @param heading
+         * @return Angle of the lattice heading, image frame
+         */
+        static double theta_of( const int heading );
+
+        /**
+         * @brief draw -> Trajectory red on a copy of img, turns on the spot blue
+         * @param img
+         * @param trajectory
+         * @return
+         */
+        static cv::Mat draw( const cv::Mat &img, const std::vector<Trajectory_Point> &trajectory );
+
+        const std::vector<Motion_Primitive> &get_primitives( const int heading ) const;
+        const Lattice_Robot &get_robot() const;
+        int get_expansions() const;
+
+        ~State_Lattice();
+
+    private:
+        Lattice_Robot robot;
+        std::vector<std::vector<Motion_Primitive>> primitives; // Per start heading
+
+        int width = 0, height = 0;
+        Bit_Plane blocked;
+        cv::Mat floor_plan;
+
+        Navigation_Field field;         // Heuristic of the last goal
+        bool field_ready = false;
+        std::unique_ptr<Thread_Pool> default_pool; // Used by plan without a pool, made on first use
+
+        // Search state per id = ( y * width + x ) * LATTICE_HEADINGS + heading, only valid
+        // when stamp[id] is generation ( open ) or generation + 1 ( closed )
+        unsigned int generation = 0;
+        std::vector<unsigned int> stamp;
+        std::vector<int> g;
+        std::vector<int> parent;
+        std::vector<uchar> parent_primitive;
+        Index_Heap open_list;
+        int expansions = 0;
+
+        void add_curve( const int heading, const cv::Point &end, const int end_heading );
+        void add_turn( const int heading, const int end_heading );
+        void add_footprint( Motion_Primitive &primitive ) const;
+        bool collides( const cv::Point &cell, const Motion_Primitive &primitive ) const;
+
+        /**
+         * @brief next_generation -> Invalidate all states for a new query
+         */
+        void next_generation();
+};
+
+#endif // STATE_LATTICE_H
@@ -0,0 +1,88 @@
+#include "Thread_Pool.h"
+
+// -----------------------------------------------------------------------
+
+Thread_Pool::Thread_Pool( const int threads ) : next_index( 0 )
+{
+    int amount_of_threads = threads;
+    if ( amount_of_threads <= 0 )
+        amount_of_threads = max( 1, (int)std::thread::hardware_concurrency() );
+
+    for (int id = 1; id < amount_of_threads; id++)
+        workers.push_back( std::thread( &Thread_Pool::worker_loop, this, id ) );
+}
+
+// -----------------------------------------------------------------------
+
+Thread_Pool::~Thread_Pool()
+{
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        stopping = true;
+    }
+    wake.notify_all();
+    for ( auto& w : workers )
+        w.join();
+}
+
+// -----------------------------------------------------------------------
+
+int Thread_Pool::get_thread_count() const { return (int)workers.size() + 1; }
+
+// -----------------------------------------------------------------------
+
+void Thread_Pool::run( const int id )
+{
+    for (size_t i = next_index++; i < count; i = next_index++)
+        (*task)( i, id );
+}
+
+// -----------------------------------------------------------------------
+
+void Thread_Pool::worker_loop( const int id )
+{
+    unsigned long seen_job = 0;
+    while ( true )
+    {
+        std::unique_lock<std::mutex> lock( mutex );
+        wake.wait( lock, [&]() { return stopping || job != seen_job; } );
+        if ( stopping )
+            return;
+        seen_job = job;
+        lock.unlock();
+
+        run( id );
+
+        lock.lock();
+        if ( --busy == 0 )
+            done.notify_all();
+    }
+}
+
+// -----------------------------------------------------------------------
+
+void Thread_Pool::parallel_for( const size_t n,
+                                const std::function<void( size_t, int )> &task )
+{
+    if ( n == 0 )
+        return;
+
+    std::lock_guard<std::mutex> call_lock( call_mutex ); // One loop at a time
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        this->task = &task;
+        count = n;
+        next_index = 0;
+        busy = workers.size();
+        job++;
+    }
+    wake.notify_all();
+
+    run( 0 );
+
+    std::unique_lock<std::mutex> lock( mutex );
+    done.wait( lock, [&]() { return busy == 0; } );
+    this->task = 0;
+}
+
+// -----------------------------------------------------------------------
@@ -0,0 +1,64 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+class Thread_Pool
+{
+    /*************************************************************
+     *  Fixed set of worker threads for data parallel loops.
+     *
+     *  parallel_for() hands out the indices [0, n) one at a time to
+     *  the workers and the calling thread, and returns when all of
+     *  them are done. Every task also gets the number of the thread
+     *  running it ( 0 = calling thread ), so callers can keep one
+     *  scratch workspace per thread instead of locking.
+     ************************************************************/
+    public:
+        /**
+         * @brief Thread_Pool
+         * @param threads => Total number of threads including the
+         *      calling thread, 0 = one per core
+         */
+        Thread_Pool( const int threads = 0 );
+
+        /**
+         * @brief parallel_for -> Run task( i, thread ) for every i in [0, n)
+         * @param n
+         * @param task
+         */
+        void parallel_for( const size_t n,
+                           const std::function<void( size_t, int )> &task );
+
+        /**
+         * @brief get_thread_count
+         * @return Number of threads used by parallel_for, at least 1
+         */
+        int get_thread_count() const;
+
+        ~Thread_Pool();
+
+    private:
+        std::vector<std::thread> workers;
+        std::mutex mutex, call_mutex;
+        std::condition_variable wake, done;
+        bool stopping = false;
+        unsigned long job = 0;
+        size_t busy = 0;
+
+        const std::function<void( size_t, int )> *task = 0;
+        size_t count = 0;
+        std::atomic<size_t> next_index;
+
+        void worker_loop( const int id );
+        void run( const int id );
+};
+
+#endif // THREAD_POOL_H
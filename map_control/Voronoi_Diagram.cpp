@@ -1,4 +1,189 @@
 #include "Voronoi_Diagram.h"
+#include "Thread_Pool.h"
+
+// x86 kernels are compiled with target attributes and picked at run time, no -mavx2 / -mssse3 needed
+#if ( defined(__GNUC__) || defined(__clang__) ) && ( defined(__x86_64__) || defined(__i386__) )
+#define THINNING_X86
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+/*
+ *  The neighbors of P1 packed into one byte, clockwise from bit 0:
+ *      P2 P3 P4 P5 P6 P7 P8 P9
+ *  remove[iter][code] = 1 if P1 is deleted in that step
+ */
+struct Thinning_Table
+{
+    uchar remove[2][256];
+    uchar bits[2][32];      // Same as remove, bit ( code & 7 ) of byte ( code >> 3 )
+
+    Thinning_Table()
+    {
+        for (int iter = 0; iter < 2; iter++)
+        {
+            for (int i = 0; i < 32; i++)
+                bits[iter][i] = 0;
+
+            for (int code = 0; code < 256; code++)
+            {
+                int p2 = ( code >> 0 ) & 1, p3 = ( code >> 1 ) & 1, p4 = ( code >> 2 ) & 1, p5 = ( code >> 3 ) & 1;
+                int p6 = ( code >> 4 ) & 1, p7 = ( code >> 5 ) & 1, p8 = ( code >> 6 ) & 1, p9 = ( code >> 7 ) & 1;
+
+                int sum  = p2 + p3 + p4 + p5 + p6 + p7 + p8 + p9;
+                int transistions  = (p2 == 0 && p3 == 1) + (p3 == 0 && p4 == 1) +
+                         (p4 == 0 && p5 == 1) + (p5 == 0 && p6 == 1) +
+                         (p6 == 0 && p7 == 1) + (p7 == 0 && p8 == 1) +
+                         (p8 == 0 && p9 == 1) + (p9 == 0 && p2 == 1);
+                int m1 = ( iter == 0 ) ? (p2 * p4 * p6) : (p2 * p4 * p8);
+                int m2 = ( iter == 0 ) ? (p4 * p6 * p8) : (p2 * p6 * p8);
+
+                remove[iter][code] = ( sum >= 2 && sum <= 6 && transistions == 1 && m1 == 0 && m2 == 0 );
+                bits[iter][ code >> 3 ] |= remove[iter][code] << ( code & 7 );
+            }
+        }
+    }
+};
+
+static const Thinning_Table THINNING_TABLE;
+
+// Row bands per thread in THINNING_BANDED
+static const int BANDS_PER_THREAD = 4;
+
+// -------------------------------------------------------------------------
+
+static inline int thinning_code( const uchar *up, const uchar *mid, const uchar *down, const int x )
+{
+    return up[x] | up[x+1] << 1 | mid[x+1] << 2 | down[x+1] << 3 |
+           down[x] << 4 | down[x-1] << 5 | mid[x-1] << 6 | up[x-1] << 7;
+}
+
+// -------------------------------------------------------------------------
+
+#if defined(THINNING_X86)
+
+/*
+ *  thinning_row for 32 pixels at a time, returns the first x it did not do
+ */
+__attribute__(( target( "avx2" ) ))
+static int thinning_avx2( const uchar *up, const uchar *mid, const uchar *down, uchar *marker, const int cols, const int iter )
+{
+    int x = 1;
+    const __m256i lo = _mm256_broadcastsi128_si256( _mm_loadu_si128( (const __m128i*)THINNING_TABLE.bits[iter] ) );
+    const __m256i hi = _mm256_broadcastsi128_si256( _mm_loadu_si128( (const __m128i*)( THINNING_TABLE.bits[iter] + 16 ) ) );
+    const __m256i powers = _mm256_setr_epi8( 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                             1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128 );
+    for (; x + 32 < cols; x += 32)
+    {
+        // Pixels are 0 or 1, so 16 bit shifts never carry into the next byte
+        #define LOAD( p ) _mm256_loadu_si256( (const __m256i*)( p ) )
+        __m256i code = _mm256_or_si256(
+            _mm256_or_si256( _mm256_or_si256( LOAD( up + x ), _mm256_slli_epi16( LOAD( up + x+1 ), 1 ) ),
+                             _mm256_or_si256( _mm256_slli_epi16( LOAD( mid + x+1 ), 2 ), _mm256_slli_epi16( LOAD( down + x+1 ), 3 ) ) ),
+            _mm256_or_si256( _mm256_or_si256( _mm256_slli_epi16( LOAD( down + x ), 4 ), _mm256_slli_epi16( LOAD( down + x-1 ), 5 ) ),
+                             _mm256_or_si256( _mm256_slli_epi16( LOAD( mid + x-1 ), 6 ), _mm256_slli_epi16( LOAD( up + x-1 ), 7 ) ) ) );
+        __m256i center = LOAD( mid + x );
+        #undef LOAD
+
+        __m256i index = _mm256_and_si256( _mm256_srli_epi16( code, 3 ), _mm256_set1_epi8( 31 ) );
+        __m256i upper = _mm256_cmpeq_epi8( _mm256_and_si256( index, _mm256_set1_epi8( 16 ) ), _mm256_set1_epi8( 16 ) );
+        __m256i byte = _mm256_blendv_epi8( _mm256_shuffle_epi8( lo, index ), _mm256_shuffle_epi8( hi, index ), upper );
+        __m256i bit = _mm256_shuffle_epi8( powers, _mm256_and_si256( code, _mm256_set1_epi8( 7 ) ) );
+        __m256i keep = _mm256_cmpeq_epi8( _mm256_and_si256( byte, bit ), _mm256_setzero_si256() );
+        _mm256_storeu_si256( (__m256i*)( marker + x ), _mm256_andnot_si256( keep, center ) );
+    }
+    return x;
+}
+
+// -------------------------------------------------------------------------
+
+/*
+ *  thinning_row for 16 pixels at a time, returns the first x it did not do
+ */
+__attribute__(( target( "ssse3" ) ))
+static int thinning_ssse3( const uchar *up, const uchar *mid, const uchar *down, uchar *marker, const int cols, const int iter )
+{
+    int x = 1;
+    const __m128i lo = _mm_loadu_si128( (const __m128i*)THINNING_TABLE.bits[iter] );
+    const __m128i hi = _mm_loadu_si128( (const __m128i*)( THINNING_TABLE.bits[iter] + 16 ) );
+    const __m128i powers = _mm_setr_epi8( 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128 );
+    for (; x + 16 < cols; x += 16)
+    {
+        // Pixels are 0 or 1, so 16 bit shifts never carry into the next byte
+        #define LOAD( p ) _mm_loadu_si128( (const __m128i*)( p ) )
+        __m128i code = _mm_or_si128(
+            _mm_or_si128( _mm_or_si128( LOAD( up + x ), _mm_slli_epi16( LOAD( up + x+1 ), 1 ) ),
+                          _mm_or_si128( _mm_slli_epi16( LOAD( mid + x+1 ), 2 ), _mm_slli_epi16( LOAD( down + x+1 ), 3 ) ) ),
+            _mm_or_si128( _mm_or_si128( _mm_slli_epi16( LOAD( down + x ), 4 ), _mm_slli_epi16( LOAD( down + x-1 ), 5 ) ),
+                          _mm_or_si128( _mm_slli_epi16( LOAD( mid + x-1 ), 6 ), _mm_slli_epi16( LOAD( up + x-1 ), 7 ) ) ) );
+        __m128i center = LOAD( mid + x );
+        #undef LOAD
+
+        __m128i index = _mm_and_si128( _mm_srli_epi16( code, 3 ), _mm_set1_epi8( 31 ) );
+        __m128i upper = _mm_cmpeq_epi8( _mm_and_si128( index, _mm_set1_epi8( 16 ) ), _mm_set1_epi8( 16 ) );
+        __m128i byte = _mm_or_si128( _mm_andnot_si128( upper, _mm_shuffle_epi8( lo, index ) ),
+                                     _mm_and_si128( upper, _mm_shuffle_epi8( hi, index ) ) );
+        __m128i bit = _mm_shuffle_epi8( powers, _mm_and_si128( code, _mm_set1_epi8( 7 ) ) );
+        __m128i keep = _mm_cmpeq_epi8( _mm_and_si128( byte, bit ), _mm_setzero_si128() );
+        _mm_storeu_si128( (__m128i*)( marker + x ), _mm_andnot_si128( keep, center ) );
+    }
+    return x;
+}
+
+// -------------------------------------------------------------------------
+
+/*
+ *  2 = AVX2, 1 = SSSE3, 0 = scalar only, asked once per process
+ */
+static int thinning_simd_level()
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports( "avx2" ) ? 2 : __builtin_cpu_supports( "ssse3" ) ? 1 : 0;
+}
+
+#endif
+
+// -------------------------------------------------------------------------
+
+void Voronoi_Diagram::thinning_row( const uchar *up,
+                                    const uchar *mid,
+                                    const uchar *down,
+                                    uchar *marker,
+                                    const int cols,
+                                    const int iter )
+{
+    int x = 1;
+
+#if defined(THINNING_X86)
+    static const int simd_level = thinning_simd_level();
+    if ( simd_level == 2 )
+        x = thinning_avx2( up, mid, down, marker, cols, iter );
+    else if ( simd_level == 1 )
+        x = thinning_ssse3( up, mid, down, marker, cols, iter );
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const uint8x16x2_t table = { { vld1q_u8( THINNING_TABLE.bits[iter] ), vld1q_u8( THINNING_TABLE.bits[iter] + 16 ) } };
+    static const uchar POWERS[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    const uint8x16_t powers = vld1q_u8( POWERS );
+    for (; x + 16 < cols; x += 16)
+    {
+        uint8x16_t code = vorrq_u8(
+            vorrq_u8( vorrq_u8( vld1q_u8( up + x ), vshlq_n_u8( vld1q_u8( up + x+1 ), 1 ) ),
+                      vorrq_u8( vshlq_n_u8( vld1q_u8( mid + x+1 ), 2 ), vshlq_n_u8( vld1q_u8( down + x+1 ), 3 ) ) ),
+            vorrq_u8( vorrq_u8( vshlq_n_u8( vld1q_u8( down + x ), 4 ), vshlq_n_u8( vld1q_u8( down + x-1 ), 5 ) ),
+                      vorrq_u8( vshlq_n_u8( vld1q_u8( mid + x-1 ), 6 ), vshlq_n_u8( vld1q_u8( up + x-1 ), 7 ) ) ) );
+        uint8x16_t byte = vqtbl2q_u8( table, vshrq_n_u8( code, 3 ) );
+        uint8x16_t bit = vqtbl1q_u8( powers, vandq_u8( code, vdupq_n_u8( 7 ) ) );
+        vst1q_u8( marker + x, vandq_u8( vtstq_u8( byte, bit ), vld1q_u8( mid + x ) ) );
+    }
+#endif
+
+    // Scalar for the rest of the row, or all of it without SIMD
+    const uchar *remove = THINNING_TABLE.remove[iter];
+    for (; x < cols-1; x++)
+        marker[x] = mid[x] & remove[ thinning_code( up, mid, down, x ) ];
+}
+
 
 // -------------------------------------------------------------------------
 
@@ -22,6 +207,16 @@ void Voronoi_Diagram::get_skeletinize_img( const cv::Mat &src, cv::Mat &dst) { s
 
 // -------------------------------------------------------------------------
 
+void Voronoi_Diagram::get_thinned_img( const cv::Mat &src, cv::Mat &dst )
+{
+    Mat binary;
+    threshold( src, binary, 0, 1, CV_THRESH_BINARY );
+    make_voronoi( binary );
+    dst = binary;
+}
+
+// -------------------------------------------------------------------------
+
 void Voronoi_Diagram::voronoi( const cv::Mat &input,
                                cv::Mat &output_img )
 {
@@ -101,66 +296,189 @@ void Voronoi_Diagram::skeletinize( const cv::Mat &input,
 
 void Voronoi_Diagram::thinning_iteration( cv::Mat &img, int iter)
 {
-    cv::Mat marker = cv::Mat::zeros( img.size(), CV_8UC1 );
-    for (int y = 1; y < img.rows-1; y++)
-        for (int x = 1; x < img.cols-1; x++)
+    if ( img.rows < 3 )
+        return;
+
+    // The first and last row never change, they are their own halos
+    std::vector<uchar> buffer;
+    thin_band( img, iter, 1, img.rows-1, img.ptr<uchar>( 0 ), img.ptr<uchar>( img.rows-1 ), buffer );
+}
+
+// -------------------------------------------------------------------------
+
+int Voronoi_Diagram::thin_band( cv::Mat &img,
+                                const int iter,
+                                const int begin,
+                                const int end,
+                                const uchar *top,
+                                const uchar *bottom,
+                                std::vector<uchar> &buffer )
+{
+    // Rows are thinned in place, the unchanged copy of the row above keeps the deletions simultaneous
+    int cols = img.cols, deleted = 0;
+    buffer.resize( 3 * (size_t)cols );
+    uchar *above = buffer.data(), *current = above + cols, *marker = current + cols;
+    std::copy( top, top + cols, above );
+    for (int y = begin; y < end; y++)
+    {
+        uchar *row = img.ptr<uchar>( y );
+        std::copy( row, row + cols, current );
+        thinning_row( above, current, ( y+1 == end ) ? bottom : img.ptr<uchar>( y+1 ), marker, cols, iter );
+        for (int x = 1; x < cols-1; x++)
         {
-            int p9 = (int)img.at<uchar>( y-1, x-1 );
-            int p2 = (int)img.at<uchar>( y-1, x );
-            int p3 = (int)img.at<uchar>( y-1, x+1 );
-            int p4 = (int)img.at<uchar>( y, x+1 );
-            int p5 = (int)img.at<uchar>( y+1, x+1 );
-            int p6 = (int)img.at<uchar>( y+1, x );
-            int p7 = (int)img.at<uchar>( y+1, x-1 );
-            int p8 = (int)img.at<uchar>( y, x-1 );
-
-            // The number of neighboring white pixels is at least 2 and not greater than 6
-            int sum  = p2 + p3 + p4 + p5 + p6 + p7 + p8 + p9;
-            if ( sum < 2 || sum > 6 )
-                continue;
-
-            // The number of white-to-black transistions around P1 is equal to 1
-            int transistions  = (p2 == 0 && p3 == 1) + (p3 == 0 && p4 == 1) +
-                     (p4 == 0 && p5 == 1) + (p5 == 0 && p6 == 1) +
-                     (p6 == 0 && p7 == 1) + (p7 == 0 && p8 == 1) +
-                     (p8 == 0 && p9 == 1) + (p9 == 0 && p2 == 1);
-            if ( transistions != 1 )
-                continue;
-
-            // if iter = 0 => step one
-            //      m1 => at least one of P2, P4 or P6 is black
-            //      m2 => at least one of P4, P6 or P8 is black
-            // if iter = 1 => step two
-            //      m1 => at least one of P2, P4 or P8 is black
-            //      m2 => at least one of P2, P6 or P8 is black
-            int m1 = ( iter == 0 ) ? (p2 * p4 * p6) : (p2 * p4 * p8);
-            int m2 = ( iter == 0 ) ? (p4 * p6 * p8) : (p2 * p6 * p8);
-            if (m1 == 0 && m2 == 0)
-                marker.at<uchar>(y,x) = 1;
+            row[x] = current[x] & ~marker[x];
+            deleted += marker[x];
         }
-
-    img &= ~marker;
+        std::swap( above, current );
+    }
+    return deleted;
 }
 
 // -------------------------------------------------------------------
 
 void Voronoi_Diagram::make_voronoi( cv::Mat &img )
 {
-    cv::Mat prev = cv::Mat::zeros( img.size(), CV_8UC1 ), diff;
-    do
+    if ( thinning_mode == THINNING_FRONTIER )
+        frontier_thinning( img );
+    else if ( thinning_mode == THINNING_BANDED )
+        banded_thinning( img );
+    else
     {
-        thinning_iteration( img, 0 );
-        thinning_iteration( img, 1 );
-        cv::absdiff( img, prev, diff );
-        img.copyTo( prev );
+        cv::Mat prev = cv::Mat::zeros( img.size(), CV_8UC1 ), diff;
+        do
+        {
+            thinning_iteration( img, 0 );
+            thinning_iteration( img, 1 );
+            cv::absdiff( img, prev, diff );
+            img.copyTo( prev );
+        }
+        while ( cv::countNonZero( diff ) > 0 );
     }
-    while ( cv::countNonZero( diff ) > 0 );
 
     img *= 255;
 }
 
 // -------------------------------------------------------------------
 
+void Voronoi_Diagram::frontier_thinning( cv::Mat &img )
+{
+    // candidates[iter] => set pixels whose neighborhood changed since step iter last looked at them
+    int cols = img.cols, rows = img.rows;
+    std::vector<int> candidates[2], deleted;
+    std::vector<uchar> queued( (size_t)rows * cols, 0 ); // Bit iter => in candidates[iter]
+    for (int y = 1; y < rows-1; y++)
+    {
+        const uchar *row = img.ptr<uchar>( y );
+        for (int x = 1; x < cols-1; x++)
+            if ( row[x] )
+            {
+                candidates[0].push_back( y * cols + x );
+                queued[ y * cols + x ] = 3;
+            }
+    }
+    candidates[1] = candidates[0];
+
+    // Same steps in the same order as the full scan, so the skeleton is the same
+    for (int iter = 0; !candidates[0].empty() || !candidates[1].empty(); iter ^= 1)
+    {
+        const uchar *remove = THINNING_TABLE.remove[iter];
+        deleted.clear();
+        for ( auto& id : candidates[iter] )
+        {
+            queued[id] &= ~( 1 << iter );
+            int y = id / cols, x = id % cols;
+            const uchar *mid = img.ptr<uchar>( y );
+            if ( mid[x] && remove[ thinning_code( img.ptr<uchar>( y-1 ), mid, img.ptr<uchar>( y+1 ), x ) ] )
+                deleted.push_back( id );
+        }
+        candidates[iter].clear();
+
+        for ( auto& id : deleted )
+            img.ptr<uchar>( id / cols )[ id % cols ] = 0;
+
+        // The neighbors of deleted pixels are looked at again by both steps
+        for ( auto& id : deleted )
+        {
+            int y = id / cols, x = id % cols;
+            for (int ny = max( y-1, 1 ); ny <= min( y+1, rows-2 ); ny++)
+            {
+                const uchar *row = img.ptr<uchar>( ny );
+                for (int nx = max( x-1, 1 ); nx <= min( x+1, cols-2 ); nx++)
+                {
+                    int n = ny * cols + nx;
+                    if ( !row[nx] )
+                        continue;
+                    for (int step = 0; step < 2; step++)
+                        if ( !( queued[n] & ( 1 << step ) ) )
+                        {
+                            candidates[step].push_back( n );
+                            queued[n] |= 1 << step;
+                        }
+                }
+            }
+        }
+    }
+}
+
+// -------------------------------------------------------------------
+
+void Voronoi_Diagram::banded_thinning( cv::Mat &img )
+{
+    if ( img.rows < 3 )
+        return;
+
+    // Row bands over the inner rows, a few per thread so uneven bands even out
+    Thread_Pool pool( thinning_threads );
+    int cols = img.cols, inner = img.rows - 2;
+    int bands = min( inner, pool.get_thread_count() * BANDS_PER_THREAD );
+    std::vector<int> first( bands + 1 );
+    for (int b = 0; b <= bands; b++)
+        first[b] = 1 + (int)( (long long)inner * b / bands );
+
+    std::vector<std::vector<uchar>> halos( bands, std::vector<uchar>( 2 * (size_t)cols ) ), buffers( bands );
+    std::vector<int> deleted( bands, 0 );
+    for (bool changed = true; changed; )
+    {
+        changed = false;
+        for (int iter = 0; iter < 2; iter++)
+        {
+            // Halos are copied before any band changes its rows, parallel_for returning is the barrier
+            for (int b = 0; b < bands; b++)
+            {
+                const uchar *top = img.ptr<uchar>( first[b] - 1 ), *bottom = img.ptr<uchar>( first[b+1] );
+                std::copy( top, top + cols, halos[b].begin() );
+                std::copy( bottom, bottom + cols, halos[b].begin() + cols );
+            }
+
+            pool.parallel_for( bands, [&]( size_t b, int )
+            {
+                deleted[b] = thin_band( img, iter, first[b], first[b+1], halos[b].data(), halos[b].data() + cols, buffers[b] );
+            } );
+
+            for (int b = 0; b < bands; b++)
+                changed |= ( deleted[b] > 0 );
+        }
+    }
+}
+
+// -------------------------------------------------------------------
+
+void Voronoi_Diagram::set_thinning_mode( const int mode ) { thinning_mode = mode; }
+
+// -------------------------------------------------------------------
+
+int Voronoi_Diagram::get_thinning_mode() { return thinning_mode; }
+
+// -------------------------------------------------------------------
+
+void Voronoi_Diagram::set_thinning_threads( const int threads ) { thinning_threads = threads; }
+
+// -------------------------------------------------------------------
+
+int Voronoi_Diagram::get_thinning_threads() { return thinning_threads; }
+
+// -------------------------------------------------------------------
+
 void Voronoi_Diagram::print_map( const cv::Mat &img,
                                  const string &s )
 {
@@ -14,6 +14,10 @@
 using namespace std;
 using namespace cv;
 
+const int THINNING_FULL_SCAN = 0;   // Every pass scans the whole image (original)
+const int THINNING_FRONTIER = 1;    // Only pixels next to the last deletions are looked at again
+const int THINNING_BANDED = 2;      // Full scans split into row bands over a thread pool
+
 class Voronoi_Diagram {
     /*************************************************************
      *                      ZHANG-SUEN Algorithm:
@@ -62,6 +66,14 @@ class Voronoi_Diagram {
          */
         void get_thinning_img( const cv::Mat &src, cv::Mat &dst );
 
+        /**
+         * @brief get_thinned_img -> Zhang-Suen thinning of a binary image,
+         *      the first and last row and column are never changed
+         * @param src -> CV_8UC1, nonzero = set
+         * @param dst -> CV_8UC1, 255 = skeleton
+         */
+        void get_thinned_img( const cv::Mat &src, cv::Mat &dst );
+
         /**
          * @brief get_skeletinize_img
          * @param srce
@@ -76,6 +88,23 @@ class Voronoi_Diagram {
          */
         void imageSegmentation( const cv::Mat &src, cv::Mat &dst );
 
+        /**
+         * @brief set_thinning_mode
+         * @param mode => THINNING_FULL_SCAN, THINNING_FRONTIER or
+         *      THINNING_BANDED, all give the same skeleton
+         */
+        void set_thinning_mode( const int mode );
+
+        int get_thinning_mode();
+
+        /**
+         * @brief set_thinning_threads
+         * @param threads => Threads of THINNING_BANDED, 0 = one per core
+         */
+        void set_thinning_threads( const int threads );
+
+        int get_thinning_threads();
+
     protected:
         /**
          * @brief voronoi
@@ -111,13 +140,69 @@ class Voronoi_Diagram {
          */
         void thinning_iteration( cv::Mat &img, int iter );
 
+        /**
+         * @brief thinning_row -> Mark the pixels of one row that a thinning
+         *      step deletes. The 3x3 neighborhood is packed into one byte and
+         *      looked up in a table, 16 or 32 pixels at a time with SSSE3,
+         *      AVX2 or NEON. On x86 the CPU is asked at run time, so no
+         *      -mssse3 / -mavx2 is needed.
+         * @param up, mid, down -> Rows y-1, y and y+1, range = 0-1
+         * @param marker -> 1 = delete, set for x = 1 to cols-2
+         * @param cols
+         * @param iter -> 0 = step one, 1 = step two
+         */
+        static void thinning_row( const uchar *up,
+                                  const uchar *mid,
+                                  const uchar *down,
+                                  uchar *marker,
+                                  const int cols,
+                                  const int iter );
+
         /**
          * @brief make_voronoi -> Function for thinning the given binary image
          * @param img -> binary image with range = 0 - 255
          */
         void make_voronoi( cv::Mat &img );
 
+        /**
+         * @brief frontier_thinning -> Thinning that keeps a queue of candidate
+         *      pixels per step, the set pixels next to the last deletions.
+         *      Stops when both queues are empty, so late passes only cost as
+         *      much as the few pixels that still change.
+         * @param img -> Binary image with range = 0-1
+         */
+        void frontier_thinning( cv::Mat &img );
+
+        /**
+         * @brief banded_thinning -> Full scan thinning with the inner rows split
+         *      into bands. Every step copies the row above and below each band
+         *      ( the halos ), then thins all bands in parallel, so the result is
+         *      the same as with one thread.
+         * @param img -> Binary image with range = 0-1
+         */
+        void banded_thinning( cv::Mat &img );
+
+        /**
+         * @brief thin_band -> One thinning step over the rows [begin, end)
+         * @param img -> Binary image with range = 0-1
+         * @param iter -> 0 = step one, 1 = step two
+         * @param begin, end
+         * @param top, bottom -> Rows begin-1 and end as they were before the step
+         * @param buffer -> Scratch rows
+         * @return Number of deleted pixels
+         */
+        static int thin_band( cv::Mat &img,
+                              const int iter,
+                              const int begin,
+                              const int end,
+                              const uchar *top,
+                              const uchar *bottom,
+                              std::vector<uchar> &buffer );
+
         void print_map( const cv::Mat &img, const string &s );
+
+        int thinning_mode = THINNING_FRONTIER;
+        int thinning_threads = 0;
 };
 
 #endif // VORONI_DIAGRAM_H
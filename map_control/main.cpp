@@ -17,8 +17,20 @@
 #include "path_planning.h"
 #include "Voronoi_Diagram.h"
 #include "A_Star.h"
+#include "Prepared_Roadmap.h"
+#include "Path_Cache.h"
+#include "Roadmap_Snap_Field.h"
+#include "Landmark_Table.h"
+#include "Roadmap_Graph.h"
+#include "Roadmap_Distance_Table.h"
+#include "Contraction_Hierarchy.h"
+#include "Navigation_Field.h"
 #include "DetectRooms.h"
+#include "Room_Planner.h"
 #include "Boustrophedon.h"
+#include "State_Lattice.h"
+#include "Generalized_Voronoi.h"
+#include "Segment_Voronoi.h"
 
 #include <random>
 using namespace std;
@@ -42,6 +54,470 @@ void draw_pixel_red(vector<Point> &v, Mat &img)
     }
 }
 
+void randomFreePairs(Mat &floorPlan, int queries, vector<Point> &starts, vector<Point> &goals)
+{
+    // Random start and goal pairs on free pixels of the floor plan, the same pairs on every call
+    default_random_engine generator;
+    uniform_int_distribution<int> distribution_x(0, floorPlan.cols-1);
+    uniform_int_distribution<int> distribution_y(0, floorPlan.rows-1);
+    starts.clear();
+    goals.clear();
+    while((int)starts.size() < queries)
+    {
+        Point s(distribution_x(generator), distribution_y(generator));
+        Point g(distribution_x(generator), distribution_y(generator));
+        if(s != g && floorPlan.at<Vec3b>(s) != Vec3b(0,0,0) && floorPlan.at<Vec3b>(g) != Vec3b(0,0,0))
+        {
+            starts.push_back(s);
+            goals.push_back(g);
+        }
+    }
+}
+
+void benchmarkOpenListPolicies(A_Star *a, Mat &roadmap, vector<Point> &roadmapPoints, int queries)
+{
+    // Same random roadmap start and goal pairs for every open list policy
+    default_random_engine generator;
+    uniform_int_distribution<size_t> distribution(0, roadmapPoints.size()-1);
+    vector<Point> starts, goals;
+    for(int i = 0; i < queries; i++)
+    {
+        starts.push_back(roadmapPoints[distribution(generator)]);
+        goals.push_back(roadmapPoints[distribution(generator)]);
+    }
+
+    string names[] = {"Linear", "Binary heap", "Bucket"};
+    int policies[] = {OPEN_LIST_LINEAR, OPEN_LIST_BINARY_HEAP, OPEN_LIST_BUCKET};
+    int oldPolicy = a->get_open_list_policy();
+    for(int p = 0; p < 3; p++)
+    {
+        a->set_open_list_policy(policies[p]);
+        Counting_Search_Observer stats; // Nothing is drawn while timing
+        auto begin = chrono::steady_clock::now();
+        for(int i = 0; i < queries; i++)
+            a->get_path(roadmap, starts[i], goals[i], stats);
+        auto end = chrono::steady_clock::now();
+        cout << names[p] << ": " << chrono::duration<double, milli>(end - begin).count() << " ms, total path length: " << stats.path_length
+             << ", expanded: " << stats.expanded << ", opened: " << stats.opened << endl;
+    }
+    a->set_open_list_policy(oldPolicy);
+}
+
+void benchmarkJumpPointSearch(A_Star *a, Mat &floorPlan, int queries)
+{
+    // Random free start and goal pairs directly on the floor plan, no roadmap
+    vector<Point> starts, goals;
+    randomFreePairs(floorPlan, queries, starts, goals);
+
+    // Both modes with the octile distance ( a table without landmarks ), the default heuristic can overestimate
+    Landmark_Table octile(floorPlan, 0, true);
+    const Landmark_Table *oldLandmarks = a->get_landmarks();
+    a->set_landmarks(&octile);
+
+    string names[] = {"Neighbors", "Jump points"};
+    int modes[] = {EXPANSION_NEIGHBORS, EXPANSION_JUMP_POINTS};
+    int oldMode = a->get_expansion_mode();
+    vector<int> costs(queries);
+    int differentCosts = 0;
+    for(int m = 0; m < 2; m++)
+    {
+        a->set_expansion_mode(modes[m]);
+        Counting_Search_Observer stats;
+        auto begin = chrono::steady_clock::now();
+        for(int i = 0; i < queries; i++)
+        {
+            vector<Point> path = a->get_floor_plan_path(floorPlan, starts[i], goals[i], stats);
+            int cost = 0;
+            Point prev = starts[i];
+            for(auto& p : path)
+            {
+                cost += (p.x != prev.x && p.y != prev.y) ? G_SKEW : G_DIRECT;
+                prev = p;
+            }
+            if(m == 0)
+                costs[i] = cost;
+            else if(cost != costs[i])
+                differentCosts++;
+        }
+        auto end = chrono::steady_clock::now();
+        cout << names[m] << ": " << chrono::duration<double, milli>(end - begin).count() << " ms, total path length: " << stats.path_length
+             << ", expanded: " << stats.expanded << ", opened: " << stats.opened << endl;
+    }
+    cout << "Queries with a different path cost: " << differentCosts << "/" << queries << endl;
+    a->set_expansion_mode(oldMode);
+    a->set_landmarks(oldLandmarks);
+}
+
+void benchmarkAnytime(A_Star *a, Mat &floorPlan, Point start, Point goal, double budgetMs)
+{
+    // Every improved path is printed with its bound, as the control loop would get it
+    Anytime_Result result = a->get_anytime_path(floorPlan, start, goal, budgetMs, true, [](const Anytime_Result &r)
+    {
+        cout << "Epsilon <= " << r.epsilon << " after " << r.elapsed_ms << " ms, path length: " << r.path.size() << endl;
+    });
+    cout << "Anytime: " << result.iterations << " iterations in " << result.elapsed_ms << " ms, bound: " << result.epsilon << endl;
+}
+
+void benchmarkLandmarks(A_Star *a, Mat &floorPlan, const Landmark_Table &landmarks, int queries)
+{
+    // Same random free pairs with the octile distance ( a table without landmarks ) and with ALT
+    vector<Point> starts, goals;
+    randomFreePairs(floorPlan, queries, starts, goals);
+
+    Landmark_Table octile(floorPlan, 0, true);
+    string names[] = {"Octile", "ALT"};
+    const Landmark_Table *tables[] = {&octile, &landmarks};
+    const Landmark_Table *oldLandmarks = a->get_landmarks();
+    long long expanded[2];
+    for(int t = 0; t < 2; t++)
+    {
+        a->set_landmarks(tables[t]);
+        Counting_Search_Observer stats;
+        auto begin = chrono::steady_clock::now();
+        for(int i = 0; i < queries; i++)
+            a->get_floor_plan_path(floorPlan, starts[i], goals[i], stats);
+        auto end = chrono::steady_clock::now();
+        expanded[t] = stats.expanded;
+        cout << names[t] << ": " << chrono::duration<double, milli>(end - begin).count() << " ms, total path length: " << stats.path_length
+             << ", expanded: " << stats.expanded << ", opened: " << stats.opened << endl;
+    }
+    cout << "ALT with " << landmarks.get_landmarks().size() << " landmarks expands "
+         << 100.0 * (expanded[0] - expanded[1]) / max(expanded[0], 1LL) << " % fewer nodes" << endl;
+    a->set_landmarks(oldLandmarks);
+}
+
+void benchmarkContractionHierarchy(A_Star *a, Mat &floorPlan, int queries)
+{
+    // Voronoi roadmap of the floor plan, drawn as in main
+    Mat roadmap = floorPlan.clone(), voronoi;
+    Voronoi_Diagram voronoiDiagram;
+    voronoiDiagram.get_voronoi_img(roadmap, voronoi);
+    for (int y = 0; y < voronoi.rows; y++)
+        for (int x = 0; x < voronoi.cols; x++)
+            if ((int)voronoi.at<uchar>(y,x) == 255)
+                roadmap.at<Vec3b>(y,x) = red;
+
+    auto buildBegin = chrono::steady_clock::now();
+    Roadmap_Graph graph(roadmap);
+    Contraction_Hierarchy hierarchy(graph);
+    auto buildEnd = chrono::steady_clock::now();
+    cout << "Vertices: " << hierarchy.get_vertex_count() << ", shortcuts: " << hierarchy.get_shortcut_count()
+         << ", build: " << chrono::duration<double, milli>(buildEnd - buildBegin).count() << " ms" << endl;
+
+    vector<Point> roadmapPoints = a->calculateRoadmapPoints(roadmap);
+    default_random_engine generator;
+    uniform_int_distribution<size_t> distribution(0, roadmapPoints.size()-1);
+    vector<Point> starts, goals;
+    for(int i = 0; i < queries; i++)
+    {
+        starts.push_back(roadmapPoints[distribution(generator)]);
+        goals.push_back(roadmapPoints[distribution(generator)]);
+    }
+
+    Counting_Search_Observer stats;
+    auto begin = chrono::steady_clock::now();
+    for(int i = 0; i < queries; i++)
+        a->get_path(roadmap, starts[i], goals[i], stats);
+    auto end = chrono::steady_clock::now();
+    cout << "Pixel A*: " << chrono::duration<double, milli>(end - begin).count() << " ms, total path length: " << stats.path_length << endl;
+
+    size_t totalLength = 0;
+    vector<Point> path;
+    begin = chrono::steady_clock::now();
+    for(int i = 0; i < queries; i++)
+    {
+        graph.find_path(starts[i], goals[i], path);
+        totalLength += path.size();
+    }
+    end = chrono::steady_clock::now();
+    cout << "Graph A*: " << chrono::duration<double, milli>(end - begin).count() << " ms, total path length: " << totalLength << endl;
+
+    totalLength = 0;
+    begin = chrono::steady_clock::now();
+    for(int i = 0; i < queries; i++)
+    {
+        hierarchy.find_path(starts[i], goals[i], path);
+        totalLength += path.size();
+    }
+    end = chrono::steady_clock::now();
+    cout << "Contraction hierarchy: " << chrono::duration<double, milli>(end - begin).count() << " ms, total path length: " << totalLength << endl;
+}
+
+void benchmarkNavigationField(A_Star *a, Mat &floorPlan, Point goal, int queries)
+{
+    // Many random free starts heading to the same goal
+    vector<Point> starts, goals; // Only the starts are used
+    randomFreePairs(floorPlan, queries, starts, goals);
+
+    Counting_Search_Observer stats;
+    auto begin = chrono::steady_clock::now();
+    for(int i = 0; i < queries; i++)
+        a->get_floor_plan_path(floorPlan, starts[i], goal, stats);
+    auto end = chrono::steady_clock::now();
+    cout << "A* per start: " << chrono::duration<double, milli>(end - begin).count() << " ms, total path length: " << stats.path_length << endl;
+
+    begin = chrono::steady_clock::now();
+    Navigation_Field field(floorPlan, goal, true);
+    auto built = chrono::steady_clock::now();
+    size_t totalLength = 0;
+    vector<Point> path;
+    for(int i = 0; i < queries; i++)
+    {
+        field.find_path(starts[i], path);
+        totalLength += path.size();
+    }
+    end = chrono::steady_clock::now();
+    cout << "Navigation field: " << chrono::duration<double, milli>(end - begin).count() << " ms ( build: "
+         << chrono::duration<double, milli>(built - begin).count() << " ms ), total path length: " << totalLength << endl;
+}
+
+void benchmarkAnyAngle(A_Star *a, Mat &floorPlan, int queries)
+{
+    // Waypoints the fuzzy controller would get, pixel paths against corner paths
+    vector<Point> starts, goals;
+    randomFreePairs(floorPlan, queries, starts, goals);
+
+    Line_Of_Sight sight(floorPlan);
+    size_t pixelWaypoints = 0, pulledWaypoints = 0, thetaWaypoints = 0;
+    double pixelLength = 0, pulledLength = 0, thetaLength = 0, thetaMs = 0;
+    for(int i = 0; i < queries; i++)
+    {
+        vector<Point> path = a->get_floor_plan_path(floorPlan, starts[i], goals[i]);
+        vector<Point> pulled = A_Star::pull_string(sight, starts[i], path);
+        auto begin = chrono::steady_clock::now();
+        vector<Point> theta = a->get_any_angle_path(floorPlan, starts[i], goals[i]);
+        thetaMs += chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+
+        pixelWaypoints += path.size();
+        pulledWaypoints += pulled.size();
+        thetaWaypoints += theta.size();
+        pixelLength += A_Star::euclidean_length(starts[i], path);
+        pulledLength += A_Star::euclidean_length(starts[i], pulled);
+        thetaLength += A_Star::euclidean_length(starts[i], theta);
+    }
+    cout << "Pixel path: " << pixelWaypoints << " waypoints, length: " << pixelLength << endl;
+    cout << "String pulled: " << pulledWaypoints << " waypoints, length: " << pulledLength << endl;
+    cout << "Lazy Theta*: " << thetaWaypoints << " waypoints, length: " << thetaLength << ", " << thetaMs << " ms" << endl;
+}
+
+void benchmarkStateLattice(Mat &floorPlan, int queries)
+{
+    // Trajectories for the pioneer2dx, how often it has to stop and turn on the spot
+    vector<Point> starts, goals;
+    randomFreePairs(floorPlan, queries, starts, goals);
+    default_random_engine generator;
+    uniform_int_distribution<int> distribution_heading(0, LATTICE_HEADINGS-1);
+
+    State_Lattice lattice;
+    lattice.set_map(floorPlan);
+    int found = 0, turns = 0;
+    double seconds = 0, ms = 0;
+    long long expansions = 0;
+    vector<Trajectory_Point> trajectory;
+    for(int i = 0; i < queries; i++)
+    {
+        auto begin = chrono::steady_clock::now();
+        bool ok = lattice.plan(starts[i], State_Lattice::theta_of(distribution_heading(generator)), goals[i], trajectory);
+        ms += chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+        expansions += lattice.get_expansions();
+        if(!ok)
+            continue;
+
+        found++;
+        seconds += trajectory.back().t;
+        for(size_t j = 1; j < trajectory.size(); j++)
+            if(trajectory[j].v == 0 && trajectory[j].omega != 0 && trajectory[j-1].v != 0)
+                turns++;
+    }
+    cout << "State lattice: " << found << "/" << queries << " found, " << ms << " ms, "
+         << expansions << " expansions" << endl;
+    cout << "Trajectory time: " << seconds << " s, stops to turn on the spot: " << turns << endl;
+}
+
+void benchmarkThinning(Mat &floorPlan, int scale)
+{
+    // Voronoi roadmap of the upscaled plan with every thinning mode, all must give the same skeleton
+    Mat plan;
+    resize(floorPlan, plan, floorPlan.size()*scale, 0, 0, INTER_NEAREST);
+    vector<int> modes = {THINNING_FULL_SCAN, THINNING_FRONTIER};
+    vector<int> threads = {1, 1};
+    vector<string> names = {"Full scan", "Frontier"};
+    for(int t = 1; t <= 32; t *= 2) // Banded scaling, flat once t passes the core count
+    {
+        modes.push_back(THINNING_BANDED);
+        threads.push_back(t);
+        names.push_back("Banded " + to_string(t) + " threads");
+    }
+    Mat reference;
+    for(size_t m = 0; m < modes.size(); m++)
+    {
+        Voronoi_Diagram voronoiDiagram;
+        voronoiDiagram.set_thinning_mode(modes[m]);
+        voronoiDiagram.set_thinning_threads(threads[m]);
+        Mat voronoi;
+        auto begin = chrono::steady_clock::now();
+        voronoiDiagram.get_voronoi_img(plan, voronoi);
+        auto end = chrono::steady_clock::now();
+        if(reference.empty())
+            reference = voronoi;
+        Mat diff;
+        absdiff(voronoi, reference, diff);
+        cout << names[m] << " thinning " << plan.cols << "x" << plan.rows << ": "
+             << chrono::duration<double, milli>(end - begin).count() << " ms, "
+             << (countNonZero(diff) == 0 ? "same skeleton" : "DIFFERENT skeleton") << endl;
+    }
+}
+
+void benchmarkGeneralizedVoronoi(Mat &floorPlan, int scale)
+{
+    // Roadmap from thinning against the ridge of the exact distance transform, with its clearance
+    Mat plan, voronoi;
+    resize(floorPlan, plan, floorPlan.size()*scale, 0, 0, INTER_NEAREST);
+
+    Voronoi_Diagram voronoiDiagram;
+    auto begin = chrono::steady_clock::now();
+    voronoiDiagram.get_voronoi_img(plan, voronoi);
+    auto end = chrono::steady_clock::now();
+    cout << "Thinning roadmap " << plan.cols << "x" << plan.rows << ": "
+         << chrono::duration<double, milli>(end - begin).count() << " ms, " << countNonZero(voronoi) << " pixels" << endl;
+
+    begin = chrono::steady_clock::now();
+    Generalized_Voronoi gvd(plan);
+    end = chrono::steady_clock::now();
+    const vector<float> &clearance = gvd.get_roadmap_clearance();
+    double meanClearance = 0, minClearance = clearance.empty() ? 0 : clearance[0];
+    for(auto& c : clearance)
+    {
+        meanClearance += c;
+        minClearance = min(minClearance, (double)c);
+    }
+    meanClearance /= max((size_t)1, clearance.size());
+    cout << "Distance transform roadmap: " << chrono::duration<double, milli>(end - begin).count() << " ms, "
+         << clearance.size() << " pixels, clearance min: " << minClearance << ", mean: " << meanClearance << endl;
+}
+
+void benchmarkSegmentVoronoi(Mat &floorPlan)
+{
+    // Wall segment roadmap of the plan and of upscaled copies, the graph should not grow with the resolution
+    for(int scale : {1, 5, 10})
+    {
+        Mat plan;
+        resize(floorPlan, plan, floorPlan.size()*scale, 0, 0, INTER_NEAREST);
+        auto begin = chrono::steady_clock::now();
+        Segment_Voronoi roadmap(plan, scale, scale); // Clearance and polygon tolerance in pixels, scaled with the plan
+        auto end = chrono::steady_clock::now();
+        cout << "Segment Voronoi " << plan.cols << "x" << plan.rows << ": "
+             << chrono::duration<double, milli>(end - begin).count() << " ms, " << roadmap.get_walls().size() << " wall segments, "
+             << roadmap.get_vertices().size() << " vertices, " << roadmap.get_edges().size() << " edges" << endl;
+    }
+}
+
+void benchmarkRoomPlanner(A_Star *a, Mat &floorPlan, int queries)
+{
+    auto buildBegin = chrono::steady_clock::now();
+    Room_Planner planner(floorPlan); // Rooms from DetectRooms::brushfireFindCenters
+    auto buildEnd = chrono::steady_clock::now();
+    cout << "Rooms: " << planner.get_room_count() << ", portals: " << planner.get_portals().size()
+         << ", build: " << chrono::duration<double, milli>(buildEnd - buildBegin).count() << " ms" << endl;
+
+    vector<Point> starts, goals;
+    randomFreePairs(floorPlan, queries, starts, goals);
+
+    size_t totalLength = 0;
+    vector<Point> path;
+    auto begin = chrono::steady_clock::now();
+    for(int i = 0; i < queries; i++)
+    {
+        planner.find_path(starts[i], goals[i], path);
+        totalLength += path.size();
+    }
+    auto end = chrono::steady_clock::now();
+    cout << "Room planner: " << chrono::duration<double, milli>(end - begin).count() << " ms, total path length: " << totalLength << endl;
+
+    Null_Search_Observer observer;
+    totalLength = 0;
+    begin = chrono::steady_clock::now();
+    for(int i = 0; i < queries; i++)
+        totalLength += a->get_floor_plan_path(floorPlan, starts[i], goals[i], observer).size();
+    end = chrono::steady_clock::now();
+    cout << "Pixel A*: " << chrono::duration<double, milli>(end - begin).count() << " ms, total path length: " << totalLength << endl;
+}
+
+void benchmarkPathCache(A_Star *a, Mat &roadmap, vector<Point> &roadmapPoints, vector<Point> &startPoints, vector<Point> &endPoints)
+{
+    // The random points are snapped to the roadmap as in findAstarPathLengthsForRoadmapRandom
+    Line_Of_Sight sight(roadmap);
+    vector<Point> entries, exits;
+    for(size_t i = 0; i < startPoints.size(); i++)
+    {
+        Point entry = a->findWayToRoadMap(sight, roadmapPoints, startPoints[i]);
+        Point exit = a->findWayToRoadMap(sight, roadmapPoints, endPoints[i]);
+        if(entry != exit)
+        {
+            entries.push_back(entry);
+            exits.push_back(exit);
+        }
+    }
+
+    Prepared_Roadmap preparedRoadmap(roadmap);
+    size_t totalLength = 0;
+    vector<Point> path;
+    auto begin = chrono::steady_clock::now();
+    for(size_t i = 0; i < entries.size(); i++)
+    {
+        preparedRoadmap.find_path(entries[i], exits[i], path);
+        totalLength += path.size();
+    }
+    auto end = chrono::steady_clock::now();
+    cout << "Without cache: " << chrono::duration<double, milli>(end - begin).count() << " ms, total path length: " << totalLength << endl;
+
+    Path_Cache cache(16 << 20);
+    totalLength = 0;
+    begin = chrono::steady_clock::now();
+    for(size_t i = 0; i < entries.size(); i++)
+        totalLength += a->get_cached_path(preparedRoadmap, cache, entries[i], exits[i]).size();
+    end = chrono::steady_clock::now();
+    cout << "With cache: " << chrono::duration<double, milli>(end - begin).count() << " ms, total path length: " << totalLength
+         << ", hits: " << cache.get_hits() << ", misses: " << cache.get_misses() << ", memory: " << cache.get_memory() << " bytes" << endl;
+}
+
+Roadmap_Distance_Table loadOrBuildDistanceTable(const Roadmap_Graph &graph, string file)
+{
+    // The table is stored next to the roadmap and only rebuilt when the roadmap changed
+    Roadmap_Distance_Table table;
+    if(!table.load(file, graph))
+    {
+        table.build(graph);
+        table.save(file);
+    }
+    return table;
+}
+
+Roadmap_Snap_Field loadOrBuildSnapField(const Mat &roadmap, string file)
+{
+    // Same as the distance table, only rebuilt when the roadmap changed
+    Roadmap_Snap_Field field;
+    if(!field.load(file, roadmap))
+    {
+        field.build(roadmap);
+        field.save(file);
+    }
+    return field;
+}
+
+Landmark_Table loadOrBuildLandmarks(const Mat &floorPlan, string file)
+{
+    // Room centers first, the rest by farthest point sampling, stored next to the floor plan
+    Landmark_Table landmarks;
+    if(!landmarks.load(file, floorPlan, true))
+    {
+        DetectRooms detectRooms;
+        landmarks.build(floorPlan, 8, true, detectRooms.brushfireFindCenters(floorPlan));
+        landmarks.save(file);
+    }
+    return landmarks;
+}
+
 int main( ) {
 
     Vec3b red(0,0,255), black(0,0,0), white(255,255,255), blue(255,0,0);
@@ -99,13 +575,30 @@ int main( ) {
     }
 
     vector<Point> roadmapPoints_voronoi = a->calculateRoadmapPoints(src); // Points on Roadmap
-    vector<Point> startPoints_voronoi = a->checkInvalidTestPoints(src, roadmapPoints_voronoi, startPoints);
-    vector<Point> endPoints_voronoi = a->checkInvalidTestPoints(src, roadmapPoints_voronoi, endPoints);
+    //benchmarkOpenListPolicies(a, src, roadmapPoints_voronoi, 1000);
+    //benchmarkJumpPointSearch(a, big_map1, 1000);
+    //benchmarkRoomPlanner(a, big_map1, 1000);
+    //Landmark_Table floorPlanLandmarks = loadOrBuildLandmarks(big_map1, "../map_control/big_floor_plan.alt");
+    //benchmarkLandmarks(a, big_map1, floorPlanLandmarks, 1000);
+    //benchmarkContractionHierarchy(a, big_map1, 1000);
+    //benchmarkContractionHierarchy(a, big_map2, 1000);
+    //benchmarkContractionHierarchy(a, big_map3, 1000);
+    //benchmarkNavigationField(a, big_map1, Point(big_map1.cols/2, big_map1.rows/2), 1000);
+    //benchmarkAnyAngle(a, big_map1, 1000);
+    //benchmarkStateLattice(big_map1, 100);
+    //benchmarkThinning(big_map1, 10);
+    //benchmarkGeneralizedVoronoi(big_map1, 10);
+    //benchmarkSegmentVoronoi(big_map1);
+    //benchmarkAnytime(a, big_map1, Point(10,10), Point(big_map1.cols-10, big_map1.rows-10), 10);
+    Roadmap_Snap_Field voronoiSnap = loadOrBuildSnapField(src, "../map_control/big_floor_plan_voronoi.snap"); // Nearest visible roadmap point of every pixel
+    vector<Point> startPoints_voronoi = a->checkInvalidTestPoints(src, voronoiSnap, startPoints);
+    vector<Point> endPoints_voronoi = a->checkInvalidTestPoints(src, voronoiSnap, endPoints);
 
     vector<Point> roadmapPoints_boustrophedon = a->calculateRoadmapPoints(img_Boustrophedon);
-    vector<Point> startPoints_Boustrophedoni = a->checkInvalidTestPoints(img_Boustrophedon, roadmapPoints_boustrophedon, startPoints_voronoi);
+    Roadmap_Snap_Field boustrophedonSnap = loadOrBuildSnapField(img_Boustrophedon, "../map_control/big_floor_plan_boustrophedon.snap");
+    vector<Point> startPoints_Boustrophedoni = a->checkInvalidTestPoints(img_Boustrophedon, boustrophedonSnap, startPoints_voronoi);
 
-    vector<Point> endPoints_Boustrophedon = a->checkInvalidTestPoints(img_Boustrophedon, roadmapPoints_boustrophedon, endPoints_voronoi);
+    vector<Point> endPoints_Boustrophedon = a->checkInvalidTestPoints(img_Boustrophedon, boustrophedonSnap, endPoints_voronoi);
     startPoints = startPoints_Boustrophedoni;
     endPoints = endPoints_Boustrophedon;
     // Make startpoints and endpoints same size
@@ -118,9 +611,14 @@ int main( ) {
 
     }
     cout << "test startpoint size: " << startPoints.size() << "test endpoints size: " << endPoints.size() << endl;
-    vector<double> voronoiLength = a->findAstarPathLengthsForRoadmapRandom(src, roadmapPoints_voronoi, startPoints, endPoints); // random start- and end- points
+    //benchmarkPathCache(a, src, roadmapPoints_voronoi, startPoints, endPoints);
+    Roadmap_Graph voronoiGraph(src);
+    Roadmap_Graph boustrophedonGraph(img_Boustrophedon);
+    Roadmap_Distance_Table voronoiTable = loadOrBuildDistanceTable(voronoiGraph, "../map_control/big_floor_plan_voronoi.dist");
+    Roadmap_Distance_Table boustrophedonTable = loadOrBuildDistanceTable(boustrophedonGraph, "../map_control/big_floor_plan_boustrophedon.dist");
+    vector<double> voronoiLength = a->findAstarPathLengthsForRoadmapRandom(src, startPoints, endPoints, voronoiTable, voronoiSnap); // random start- and end- points
     //vector<double> voronoiLength = a->findAstarPathLengthsForRoadmap(src); // Towards eachother
-    vector<double> BoustrophedonLength = a->findAstarPathLengthsForRoadmapRandom(img_Boustrophedon, roadmapPoints_boustrophedon, startPoints, endPoints); // random start- and end- points
+    vector<double> BoustrophedonLength = a->findAstarPathLengthsForRoadmapRandom(img_Boustrophedon, startPoints, endPoints, boustrophedonTable, boustrophedonSnap); // random start- and end- points
     //vector<double> BoustrophedonLength = a->findAstarPathLengthsForRoadmap(img_Boustrophedon); // Towards eachother
 
     // Sorts the results for plotting
@@ -170,6 +668,8 @@ int main( ) {
     myFile.close();
 */
     //Plot best and worst case map for Big_Map Boustro best at 3991 Voro best at 4598
+    // These indices are from the pixel A* lengths in Test/Roadmap/Length test, the roadmap graph
+    // lengths can be a few pixels longer and sort differently, see Roadmap_Graph
     int indexToCheck = 4598;
     Mat BoustroIndexPath = a->showPath(big_map1, img_Boustrophedon, roadmapPoints_boustrophedon, sorted_start_points[indexToCheck], sorted_end_points[indexToCheck]);
     Mat VoroIndexPath = a->showPath(big_map1, src, roadmapPoints_voronoi, sorted_start_points[indexToCheck], sorted_end_points[indexToCheck]);
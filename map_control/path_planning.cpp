@@ -326,14 +326,7 @@ bool Path_planning::obstacle_detected( const cv::Point &start,
                                        const cv::Point &goal,
                                        const cv::Mat &img )
 {
-    LineIterator it(img, start, goal, 8);
-
-    vector<Point> v = get_points(it);
-    for (size_t i = 0; i < v.size(); i++)
-        if ( (int)img.at<uchar>(v[i])==0 )
-            return true;
-
-    return false;
+    return Line_Of_Sight::obstacle_on_line( img, start, goal, Scalar(0) );
 }
 
 // -----------------------------------------------------------------
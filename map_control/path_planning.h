@@ -16,6 +16,7 @@
 #include "opencv2/ximgproc.hpp"
 
 #include "Map.h"
+#include "Line_Of_Sight.h"
 
 using namespace std;
 using namespace cv;